@@ -0,0 +1,92 @@
+#include <lazypp.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+/**
+ * Built at -O0 like a debug build: the cost of each pipeline per element and
+ * its slowdown against the equivalent hand written loop.
+ */
+static volatile uint64_t sink;
+
+template<typename Func>
+double ns_per_element(size_t elements, Func f) {
+	f(); // warm up
+	auto begin = std::chrono::steady_clock::now();
+	sink = f();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>(end - begin).count() / elements;
+}
+
+template<typename Raw, typename Pipeline>
+void bench(const char* name, size_t elements, Raw raw, Pipeline pipeline) {
+	double raw_ns = ns_per_element(elements, raw);
+	double pipeline_ns = ns_per_element(elements, pipeline);
+	std::printf("%-24s %8.2f %8.2f %8.1fx\n", name, raw_ns, pipeline_ns, pipeline_ns / raw_ns);
+}
+
+int main() {
+	const size_t n = 1 << 22;
+	std::vector<uint32_t> values = lazypp::from::random<uint32_t>(1).take(n).to<std::vector<uint32_t>>();
+	auto sum = [](uint64_t acum, uint64_t v) { return acum + v; };
+	auto triple = [](uint32_t v) { return v * 3; };
+	auto odd = [](uint32_t v) { return (v & 1) != 0; };
+
+	std::printf("%-24s %8s %8s %9s\n", "ns per element", "raw", "lazypp", "slowdown");
+
+	bench("range fold", n,
+		[&]() {
+			uint64_t s = 0;
+			for (size_t i = 0; i < n; i++)
+				s += i;
+			return s;
+		},
+		[&]() { return lazypp::from::range(size_t(0), n).fold(uint64_t(0), sum); });
+
+	bench("stl_container fold", n,
+		[&]() {
+			uint64_t s = 0;
+			for (auto v : values)
+				s += v;
+			return s;
+		},
+		[&]() { return lazypp::from::stl_container(values).fold(uint64_t(0), sum); });
+
+	bench("map filter take", n,
+		[&]() {
+			uint64_t s = 0;
+			size_t taken = 0;
+			for (auto v : values) {
+				uint32_t m = triple(v);
+				if (!odd(m))
+					continue;
+				if (taken++ == n / 4)
+					break;
+				s += m;
+			}
+			return s;
+		},
+		[&]() { return lazypp::from::stl_container(values).map(triple).filter(odd).take(n / 4).fold(uint64_t(0), sum); });
+
+	bench("staged map filter take", n,
+		[&]() {
+			uint64_t s = 0;
+			size_t taken = 0;
+			for (auto v : values) {
+				uint32_t m = triple(v);
+				if (!odd(m))
+					continue;
+				if (taken++ == n / 4)
+					break;
+				s += m;
+			}
+			return s;
+		},
+		[&]() {
+			return lazypp::from::stl_container(values)
+				.staged(lazypp::stage::map(triple), lazypp::stage::filter(odd), lazypp::stage::take(n / 4))
+				.fold(uint64_t(0), sum);
+		});
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include <lazypp.hpp>
+#include "perf_counters.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Per element costs of each iterator type: wall clock plus, when the host
+ * provides them, cycles, instructions, branch misses and L1d/LLC misses.
+ */
+static lazypp_bench::perf_counters counters;
+static volatile uint64_t sink;
+
+template<typename Func>
+void bench(const char* name, size_t elements, Func f) {
+	f(); // warm up
+	counters.start();
+	auto begin = std::chrono::steady_clock::now();
+	sink = f();
+	auto end = std::chrono::steady_clock::now();
+	counters.stop();
+
+	double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+	std::printf("%-32s %8.2f", name, ns / elements);
+	for (int c = 0; c < lazypp_bench::perf_counters::num_counters; c++) {
+		if (counters.available(c))
+			std::printf(" %9.3f", double(counters.value(c)) / elements);
+		else
+			std::printf(" %9s", "n/a");
+	}
+	std::printf("\n");
+}
+
+int main() {
+	const size_t n = 1 << 22;
+	std::vector<uint32_t> values = lazypp::from::random<uint32_t>(1).take(n).to<std::vector<uint32_t>>();
+	std::vector<uint32_t> sorted_values = lazypp::from::range(uint32_t(0), uint32_t(n)).to<std::vector<uint32_t>>();
+	std::vector<uint64_t> table = lazypp::from::random<uint64_t>(2).take(n * 4).to<std::vector<uint64_t>>();
+	std::vector<uint32_t> ids = lazypp::from::random<uint32_t>(3, [&table](uint64_t bits) { return uint32_t(bits % table.size()); })
+		.take(n).to<std::vector<uint32_t>>();
+	std::vector<uint64_t> sparse = lazypp::from::random<uint64_t>(4, [](uint64_t bits) { return bits & (bits >> 7) & (bits >> 13) & (bits >> 29); })
+		.take(n / 64).to<std::vector<uint64_t>>();
+	std::vector<uint64_t> packed = lazypp::from::stl_container(values).bitpack(17).to<std::vector<uint64_t>>();
+	std::string csv;
+	lazypp::from::range(size_t(0), n / 8)
+		.each([&csv](size_t i) { csv += std::to_string(i) + ",name" + std::to_string(i % 97) + ",\"x, y\"," + std::to_string(i * 3) + "\n"; });
+	std::string log;
+	const char* severities[] = {"INFO", "WARN", "ERROR", "DEBUG"};
+	lazypp::from::range(size_t(0), n / 16)
+		.each([&log, &severities](size_t i) {
+				log += std::string(severities[i % 7 % 4]) + " 2024-05-01T10:" + std::to_string(i % 60) + " service=api path=/users/"
+					+ std::to_string(i * 31 % 1000) + " status=" + std::to_string(i % 13 ? 200 : 500) + "\n";
+			});
+	std::vector<std::string_view> log_lines = lazypp::from::lines(log).to<std::vector<std::string_view>>();
+	auto line_count = [](uint64_t acum, std::string_view) { return acum + 1; };
+	auto sum = [](uint64_t acum, uint64_t v) { return acum + v; };
+
+	std::printf("%-32s %8s", "per element", "ns");
+	for (int c = 0; c < lazypp_bench::perf_counters::num_counters; c++)
+		std::printf(" %9s", lazypp_bench::perf_counters::name(c));
+	std::printf("\n");
+
+	bench("raw loop", n, [&]() {
+		uint64_t s = 0;
+		for (auto v : values)
+			s += v;
+		return s;
+	});
+	bench("range fold", n, [&]() { return lazypp::from::range(size_t(0), n).fold(uint64_t(0), sum); });
+	bench("stl_container fold", n, [&]() { return lazypp::from::stl_container(values).fold(uint64_t(0), sum); });
+	bench("map", n, [&]() { return lazypp::from::stl_container(values).map([](uint32_t v) { return v * 3; }).fold(uint64_t(0), sum); });
+	bench("map_batch", n, [&]() {
+			return lazypp::from::stl_container(values)
+				.map_batch([](const uint32_t* in, size_t count, uint32_t* out) {
+						// what map_batch is for: a kernel vectorized by hand
+						size_t i = 0;
+#if defined(__SSE2__)
+						for (; i + 4 <= count; i += 4) {
+							__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+							_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_add_epi32(v, _mm_add_epi32(v, v)));
+						}
+#endif
+						for (; i < count; i++)
+							out[i] = in[i] * 3;
+					})
+				.fold(uint64_t(0), sum);
+		});
+	bench("filter predictable", n, [&]() { return lazypp::from::stl_container(sorted_values).filter([n](uint32_t v) { return v < n / 2; }).fold(uint64_t(0), sum); });
+	bench("filter random 50%", n, [&]() { return lazypp::from::stl_container(values).filter([](uint32_t v) { return v & 1; }).fold(uint64_t(0), sum); });
+	bench("take", n, [&]() { return lazypp::from::stl_container(values).take(n).fold(uint64_t(0), sum); });
+	bench("take_while", n, [&]() { return lazypp::from::stl_container(values).take_while([](uint32_t) { return true; }).fold(uint64_t(0), sum); });
+	bench("generator take", n, [&]() { uint64_t i = 0; return lazypp::from::generator([&i]() { return i++; }).take(n).fold(uint64_t(0), sum); });
+	bench("random", n, [&]() { return lazypp::from::random<uint64_t>(5).take(n).fold(uint64_t(0), sum); });
+	bench("lookup map", n, [&]() { return lazypp::from::stl_container(ids).map([&table](uint32_t i) { return table[i]; }).fold(uint64_t(0), sum); });
+	bench("lookup gather", n, [&]() { return lazypp::from::stl_container(ids).gather(table, 16).fold(uint64_t(0), sum); });
+	bench("set_bits sparse", sparse.size() * 64, [&]() { return lazypp::from::set_bits(sparse).fold(uint64_t(0), sum); });
+	bench("strings find", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).filter([](std::string_view l) { return l.find("status=500") != std::string_view::npos; }).fold(uint64_t(0), line_count);
+		});
+	bench("strings compare prefix", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).filter([](std::string_view l) { return l.substr(0, 21) == "ERROR 2024-05-01T10:1"; }).fold(uint64_t(0), line_count);
+		});
+	auto first_word = [](std::string_view l) { return l.substr(0, l.find(' ')); };
+	bench("strings compare any", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).map(first_word).filter([](std::string_view w) { return w == "WARN" || w == "ERROR" || w == "FATAL"; })
+				.fold(uint64_t(0), line_count);
+		});
+	bench("strings filter_equals_any", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).map(first_word).filter_equals_any({"WARN", "ERROR", "FATAL"}).fold(uint64_t(0), line_count);
+		});
+	std::vector<std::string> keywords = lazypp::from::range(0, 200)
+		.map([](int k) { return k == 150 ? std::string("status=500") : "path=/items/" + std::to_string(k); })
+		.to<std::vector<std::string>>();
+	bench("strings find 200 keywords", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).filter([&keywords](std::string_view l) {
+					for (const std::string& k : keywords)
+						if (l.find(k) != std::string_view::npos)
+							return true;
+					return false;
+				}).fold(uint64_t(0), line_count);
+		});
+	lazypp::pattern_set keyword_set(keywords);
+	bench("strings match_any 200 keywords", log.size(), [&]() { return lazypp::from::stl_container(log_lines).match_any(keyword_set).fold(uint64_t(0), line_count); });
+	bench("strings tag_matches 200 keywords", log.size(), [&]() {
+			return lazypp::from::stl_container(log_lines).tag_matches(keyword_set)
+				.fold(uint64_t(0), [](uint64_t acum, auto&& t) { return acum + std::get<1>(t).size(); });
+		});
+	const char* levels[] = {"scalar", "sse2", "avx2", "avx512"};
+	for (int level = 0; level <= int(lazypp::host_simd_level()); level++) {
+		lazypp::limit_simd_level(lazypp::simd_level(level));
+		std::string name = std::string("bitpacked 17 bits ") + levels[level];
+		bench(name.c_str(), n, [&]() { return lazypp::from::bitpacked<uint32_t>(packed, n, 17).fold(uint64_t(0), sum); });
+		name = std::string("csv per byte ") + levels[level];
+		bench(name.c_str(), csv.size(), [&]() { return lazypp::from::csv<4>(csv).fold(uint64_t(0), [](uint64_t acum, auto&& row) { return acum + row[3].size(); }); });
+		name = std::string("strings filter_contains ") + levels[level];
+		bench(name.c_str(), log.size(), [&]() { return lazypp::from::stl_container(log_lines).filter_contains("status=500").fold(uint64_t(0), line_count); });
+		name = std::string("strings filter_prefix ") + levels[level];
+		bench(name.c_str(), log.size(), [&]() { return lazypp::from::stl_container(log_lines).filter_prefix("ERROR 2024-05-01T10:1").fold(uint64_t(0), line_count); });
+	}
+
+	return 0;
+}
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Serial compile time of a project of TUS translation units, each one with
+# a core pipeline, when every unit includes lazypp.hpp or only
+# lazypp/core.hpp. links tells whether the objects then link and run.
+#
+#   ./build_time.sh [tus]
+
+INCLUDE=$(cd ../include && pwd)
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--I$INCLUDE -O2 -fconcepts}
+TUS=${1:-32}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+# unit.cpp <first line> <k>
+unit() {
+	echo "$1"
+	echo "unsigned long unit_$2(unsigned long n) {"
+	echo "	return lazypp::from::range(0ul, n)"
+	echo "		.map([](unsigned long v) { return v * $2 + 1; })"
+	echo "		.filter([](unsigned long v) { return v % 3 != 0; })"
+	echo "		.take(n / 2)"
+	echo "		.fold(0ul, [](unsigned long a, unsigned long v) { return a + v; });"
+	echo "}"
+}
+
+main_unit() {
+	echo '#include <cstdio>'
+	k=0
+	while [ $k -lt $TUS ]; do
+		echo "unsigned long unit_$k(unsigned long n);"
+		k=$((k + 1))
+	done
+	echo 'int main() {'
+	echo '	unsigned long sum = 0;'
+	k=0
+	while [ $k -lt $TUS ]; do
+		echo "	sum += unit_$k(100);"
+		k=$((k + 1))
+	done
+	echo '	std::printf("%lu\\n", sum);'
+	echo '}'
+}
+
+# build <mode> <first line> <extra flags>
+build() {
+	dir="$OUT/$1"
+	mkdir -p "$dir"
+	main_unit > "$dir/main.cpp"
+	k=0
+	while [ $k -lt $TUS ]; do
+		unit "$2" $k > "$dir/unit_$k.cpp"
+		k=$((k + 1))
+	done
+	start=$(date +%s%N)
+	(
+		cd "$dir" || exit 1
+		for src in unit_*.cpp main.cpp; do
+			$CXX $CXXFLAGS $3 -c "$src" -o "${src%.cpp}.o" 2>> errors.txt || exit 1
+		done
+	) || { head -20 "$dir/errors.txt" >&2; return 1; }
+	end=$(date +%s%N)
+	links=no
+	(cd "$dir" && $CXX *.o -o project 2> /dev/null && ./project > /dev/null) && links=yes
+	awk -v mode=$1 -v tus=$TUS -v ns=$((end - start)) -v links=$links \
+		'BEGIN { printf "%-16s %4d %10.2f %12.3f %6s\n", mode, tus, ns / 1e9, ns / 1e9 / tus, links }'
+}
+
+printf '%-16s %4s %10s %12s %6s\n' mode tus seconds seconds_per_tu links
+build lazypp.hpp '#include <lazypp.hpp>' '' || exit 1
+build lazypp/core.hpp '#include <lazypp/core.hpp>' '' || exit 1
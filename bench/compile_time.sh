@@ -0,0 +1,62 @@
+#!/bin/sh
+# Compile time, longest mangled symbol and object size of a translation
+# unit with PIPELINES pipelines of DEPTH map/filter pairs each, written as
+# nested iterators and as a single staged() call.
+#
+#   ./compile_time.sh [depths...]
+
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--I../include -g -O0 -fconcepts}
+PIPELINES=${PIPELINES:-8}
+DEPTHS=${*:-1 2 4 8 16 32}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+# pipelines.cpp <depth> <staged>
+generate() {
+	echo '#include <lazypp.hpp>'
+	echo 'template<size_t Tag, size_t Stage> struct add { size_t operator()(size_t v) const { return v + Tag + Stage; } };'
+	echo 'template<size_t Tag, size_t Stage> struct keep { bool operator()(size_t v) const { return (v + Tag) % (Stage + 2) != 0; } };'
+	echo 'int main(int argc, char**) {'
+	echo '	size_t sum = 0;'
+	p=0
+	while [ $p -lt $PIPELINES ]; do
+		printf '\tsum += lazypp::from::range(size_t(0), size_t(argc) * 100)'
+		s=0
+		if [ $2 = 1 ]; then
+			printf '.staged('
+			while [ $s -lt $1 ]; do
+				[ $s -gt 0 ] && printf ', '
+				printf 'lazypp::stage::map(add<%d, %d>()), lazypp::stage::filter(keep<%d, %d>())' $p $s $p $s
+				s=$((s + 1))
+			done
+			printf ')'
+		else
+			while [ $s -lt $1 ]; do
+				printf '.map(add<%d, %d>()).filter(keep<%d, %d>())' $p $s $p $s
+				s=$((s + 1))
+			done
+		fi
+		printf '.fold(size_t(0), [](size_t a, size_t v) { return a + v; });\n'
+		p=$((p + 1))
+	done
+	echo '	return int(sum & 1);'
+	echo '}'
+}
+
+printf '%-8s %6s %10s %12s %12s\n' mode depth seconds max_symbol object_kb
+for depth in $DEPTHS; do
+	for staged in 0 1; do
+		mode=nested
+		[ $staged = 1 ] && mode=staged
+		src="$OUT/$mode-$depth.cpp"
+		obj="$OUT/$mode-$depth.o"
+		generate $depth $staged > "$src"
+		start=$(date +%s%N)
+		$CXX $CXXFLAGS -c "$src" -o "$obj" || exit 1
+		end=$(date +%s%N)
+		symbol=$(nm "$obj" | awk '{ if (length($NF) > m) m = length($NF) } END { print m }')
+		awk -v mode=$mode -v depth=$depth -v ns=$((end - start)) -v symbol=$symbol -v bytes=$(wc -c < "$obj") \
+			'BEGIN { printf "%-8s %6d %10.2f %12d %12d\n", mode, depth, ns / 1e9, symbol, bytes / 1024 }'
+	done
+done
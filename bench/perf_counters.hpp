@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lazypp_bench {
+
+    /**
+     * Hardware counters of the calling thread through perf_event_open.
+     * Each counter is tried on its own so that the ones the host doesn't
+     * provide (virtual machines, perf_event_paranoid, other systems) are
+     * just reported as unavailable. The others form one group, scheduled
+     * together and read at once, and are scaled by enabled / running time
+     * when the kernel multiplexed them with other events.
+     */
+    class perf_counters {
+        public:
+            enum counter {
+                cycles,
+                instructions,
+                branch_misses,
+                l1d_misses,
+                llc_misses,
+                num_counters
+            };
+
+            static const char* name(int c) {
+                static const char* names[num_counters] = {"cycles", "instr", "br-miss", "L1d-miss", "LLC-miss"};
+                return names[c];
+            }
+
+            perf_counters() : leader_(-1), opened_(0) {
+                fds_.fill(-1);
+                slots_.fill(-1);
+                values_.fill(0);
+#if defined(__linux__)
+                const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                open(cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                open(instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+                open(branch_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+                open(l1d_misses, PERF_TYPE_HW_CACHE, l1d_read_miss);
+                open(llc_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif
+            }
+
+            perf_counters(const perf_counters&) = delete;
+
+            ~perf_counters() {
+#if defined(__linux__)
+                for (int fd : fds_)
+                    if (fd >= 0)
+                        ::close(fd);
+#endif
+            }
+
+            bool available(int c) const {
+                return fds_[c] >= 0;
+            }
+
+            void start() {
+#if defined(__linux__)
+                if (leader_ < 0)
+                    return;
+                ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+            }
+
+            void stop() {
+#if defined(__linux__)
+                if (leader_ < 0)
+                    return;
+                ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+                // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, then one value per member
+                std::array<uint64_t, 3 + num_counters> data;
+                data.fill(0);
+                ssize_t size = ssize_t((3 + opened_) * sizeof(uint64_t));
+                bool read = ::read(leader_, data.data(), size_t(size)) == size;
+                uint64_t enabled = data[1];
+                uint64_t running = data[2];
+                for (int c = 0; c < num_counters; c++) {
+                    if (!read || slots_[c] < 0 || !running) {
+                        values_[c] = 0;
+                        continue;
+                    }
+                    uint64_t value = data[3 + slots_[c]];
+                    values_[c] = running < enabled ? uint64_t(double(value) * double(enabled) / double(running)) : value;
+                }
+#endif
+            }
+
+            uint64_t value(int c) const {
+                return values_[c];
+            }
+
+        private:
+#if defined(__linux__)
+            void open(int c, uint32_t type, uint64_t config) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = type;
+                attr.config = config;
+                attr.disabled = leader_ < 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                int fd = int(::syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+                if (fd < 0)
+                    return;
+                if (leader_ < 0)
+                    leader_ = fd;
+                fds_[c] = fd;
+                slots_[c] = opened_++;
+            }
+#endif
+
+            int leader_;
+            int opened_;
+            std::array<int, num_counters> fds_;
+            std::array<int, num_counters> slots_;
+            std::array<uint64_t, num_counters> values_;
+    };
+}
@@ -0,0 +1,393 @@
+#pragma once
+
+/**
+ * Prefetching, batch kernels and the integer codecs (delta, varint, bit
+ * packing) behind the matching wrapper methods.
+ */
+
+#include "core.hpp"
+#include "bits.hpp"
+#include "simd.hpp"
+
+namespace lazypp {
+
+    namespace iterators {
+        /**
+         * Reads distance elements ahead of the consumer and issues a software
+         * prefetch for the address AddrFunc gives for each of them, so the
+         * cache misses of indexed lookups overlap instead of serializing.
+         */
+        template<typename BaseIterator, typename AddrFunc> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class prefetch_iterator {
+                public:
+                    typedef typename BaseIterator::value_type value_type;
+
+                    prefetch_iterator() = delete;
+                    prefetch_iterator(size_t distance, AddrFunc addr_func, BaseIterator base)
+                        : distance_(distance ? distance : 1), addr_func_(addr_func), base_(base), head_(0) {}
+
+                    void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                        memory_.set_budget(budget);
+                    }
+
+                    std::optional<value_type> next() {
+                        if (ring_.empty()) {
+                            memory_.resize(distance_ * sizeof(std::optional<value_type>));
+                            ring_.reserve(distance_);
+                            for (size_t i = 0; i < distance_; i++)
+                                ring_.push_back(fetch());
+                        }
+
+                        std::optional<value_type> v = std::move(ring_[head_]);
+                        if (v) {
+                            ring_[head_] = fetch();
+                            head_ = (head_ + 1) % distance_;
+                        }
+                        return v;
+                    }
+
+                private:
+                    std::optional<value_type> fetch() {
+                        auto v = base_.next();
+                        if (v)
+                            LAZYPP_PREFETCH(addr_func_(*v));
+                        return v;
+                    }
+
+                    size_t distance_;
+                    AddrFunc addr_func_;
+                    BaseIterator base_;
+                    std::vector<std::optional<value_type>> ring_;
+                    detail::memory_reservation memory_;
+                    size_t head_;
+            };
+
+        /**
+         * Yields kernel(in, n, out) over batches of the base elements, see
+         * wrapper::map_batch. Bases without next_span are gathered into a
+         * buffer first. The results are handed out one by one, or as whole
+         * spans to a following map_batch.
+         */
+        template<typename BaseIterator, typename Kernel, typename T> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class map_batch_iterator {
+                public:
+                    typedef T value_type;
+                    typedef typename BaseIterator::value_type input_type;
+
+                    map_batch_iterator() = delete;
+                    map_batch_iterator(size_t batch_size, Kernel kernel, BaseIterator base)
+                        : batch_size_(batch_size ? batch_size : 1), kernel_(kernel), base_(base), pos_(0), count_(0) {}
+
+                    void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                        memory_.set_budget(budget);
+                    }
+
+                    std::optional<value_type> next() {
+                        if (pos_ == count_ && !fill())
+                            return std::optional<value_type>();
+                        return std::optional<value_type>(std::move(out_[pos_++]));
+                    }
+
+                    template<typename Sink>
+                        void drain(Sink&& sink) {
+                            // locals, so the loop doesn't reload members sink might alias
+                            while (pos_ < count_ || fill()) {
+                                value_type* out = out_.data();
+                                size_t end = count_;
+                                for (size_t i = pos_; i < end; i++)
+                                    if (!sink(std::move(out[i]))) {
+                                        pos_ = i + 1;
+                                        return;
+                                    }
+                                pos_ = end;
+                            }
+                        }
+
+                    detail::span<value_type> next_span(size_t max) {
+                        if (pos_ == count_ && !fill())
+                            return {nullptr, 0};
+                        size_t n = std::min(max, count_ - pos_);
+                        detail::span<value_type> s = {out_.data() + pos_, n};
+                        pos_ += n;
+                        return s;
+                    }
+
+                    template<typename B = BaseIterator>
+                        auto size() const -> decltype(std::declval<const B&>().size()) {
+                            return base_.size() + (count_ - pos_);
+                        }
+
+                private:
+                    bool fill() {
+                        if (out_.empty()) {
+                            memory_.resize(batch_size_ * (sizeof(value_type) + (detail::has_next_span<BaseIterator>::value ? 0 : sizeof(input_type))));
+                            out_.resize(batch_size_);
+                            if constexpr (!detail::has_next_span<BaseIterator>::value)
+                                in_.reserve(batch_size_);
+                        }
+
+                        pos_ = 0;
+                        if constexpr (detail::has_next_span<BaseIterator>::value) {
+                            auto in = base_.next_span(batch_size_);
+                            count_ = in.size;
+                            if (count_)
+                                kernel_(in.data, count_, out_.data());
+                        }
+                        else {
+                            in_.clear();
+                            while (in_.size() < batch_size_) {
+                                auto v = base_.next();
+                                if (!v)
+                                    break;
+                                in_.push_back(std::move(*v));
+                            }
+                            count_ = in_.size();
+                            if (count_)
+                                kernel_(static_cast<const input_type*>(in_.data()), count_, out_.data());
+                        }
+                        return count_ != 0;
+                    }
+
+                    size_t batch_size_;
+                    Kernel kernel_;
+                    BaseIterator base_;
+                    std::vector<input_type> in_;
+                    std::vector<value_type> out_;
+                    detail::memory_reservation memory_;
+                    size_t pos_;
+                    size_t count_;
+            };
+
+        /**
+         * Differences between consecutive elements (the first one against 0),
+         * or with Decode the running sum that undoes them.
+         */
+        template<typename BaseIterator, bool Decode> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class delta_iterator {
+                public:
+                    typedef typename BaseIterator::value_type value_type;
+
+                    delta_iterator() = delete;
+                    delta_iterator(BaseIterator base) : base_(base), previous_() {}
+
+                    std::optional<value_type> next() {
+                        auto v = base_.next();
+                        if (!v)
+                            return v;
+                        if (Decode)
+                            return std::optional<value_type>(previous_ = value_type(previous_ + *v));
+
+                        value_type delta = value_type(*v - previous_);
+                        previous_ = *v;
+                        return std::optional<value_type>(delta);
+                    }
+
+                private:
+                    BaseIterator base_;
+                    value_type previous_;
+            };
+
+        /**
+         * Bytes of the zigzag varint encoding of each integer.
+         */
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class varint_encode_iterator {
+                public:
+                    typedef uint8_t value_type;
+
+                    varint_encode_iterator() = delete;
+                    varint_encode_iterator(BaseIterator base) : base_(base), pos_(0), size_(0) {}
+
+                    std::optional<value_type> next() {
+                        if (pos_ == size_) {
+                            auto v = base_.next();
+                            if (!v)
+                                return std::optional<value_type>();
+                            size_ = detail::put_varint(detail::to_varint_value(*v), bytes_);
+                            pos_ = 0;
+                        }
+                        return std::optional<value_type>(bytes_[pos_++]);
+                    }
+
+                private:
+                    BaseIterator base_;
+                    uint8_t bytes_[10];
+                    size_t pos_;
+                    size_t size_;
+            };
+
+        /**
+         * Integers decoded from a sequence of varint bytes.
+         */
+        template<typename BaseIterator, typename T> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class varint_decode_iterator {
+                public:
+                    typedef T value_type;
+
+                    varint_decode_iterator() = delete;
+                    varint_decode_iterator(BaseIterator base) : base_(base) {}
+
+                    std::optional<value_type> next() {
+                        uint64_t v = 0;
+                        for (unsigned shift = 0; shift < 64; shift += 7) {
+                            auto byte = base_.next();
+                            if (!byte) {
+                                if (shift)
+                                    throw std::runtime_error("lazypp: truncated varint");
+                                return std::optional<value_type>();
+                            }
+                            v |= uint64_t(*byte & 0x7f) << shift;
+                            if (!(*byte & 0x80))
+                                return std::optional<value_type>(detail::from_varint_value<T>(v));
+                        }
+                        throw std::runtime_error("lazypp: overlong varint");
+                    }
+
+                private:
+                    BaseIterator base_;
+            };
+
+        /**
+         * Varints decoded straight from memory.
+         */
+        template<typename T>
+            class varint_iterator {
+                public:
+                    typedef T value_type;
+
+                    varint_iterator() = delete;
+                    varint_iterator(const uint8_t* first, const uint8_t* last) : actual_(first), last_(last) {}
+
+                    std::optional<value_type> next() {
+                        if (actual_ >= last_)
+                            return std::optional<value_type>();
+                        uint64_t v;
+                        if (!detail::get_varint(actual_, last_, v))
+                            throw std::runtime_error("lazypp: truncated varint");
+                        return std::optional<value_type>(detail::from_varint_value<T>(v));
+                    }
+
+                private:
+                    const uint8_t* actual_;
+                    const uint8_t* last_;
+            };
+
+        /**
+         * Packs the low bits of each element into 64 bit words, little endian,
+         * a value may straddle two words. The last word is zero padded. With
+         * 0 bits there is nothing to pack and the base is never pulled (it
+         * may be infinite).
+         */
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class bitpack_iterator {
+                public:
+                    typedef uint64_t value_type;
+
+                    bitpack_iterator() = delete;
+                    bitpack_iterator(unsigned bits, BaseIterator base) : bits_(std::min(bits, 64u)), base_(base), word_(0), filled_(0), ended_(bits == 0) {}
+
+                    std::optional<value_type> next() {
+                        while (!ended_ && filled_ < 64) {
+                            auto v = base_.next();
+                            if (!v) {
+                                ended_ = true;
+                                break;
+                            }
+
+                            uint64_t x = uint64_t(*v) & detail::low_bits_mask(bits_);
+                            word_ |= x << filled_;
+                            if (filled_ + bits_ > 64) {
+                                uint64_t word = word_;
+                                word_ = x >> (64 - filled_);
+                                filled_ = filled_ + bits_ - 64;
+                                return std::optional<value_type>(word);
+                            }
+                            filled_ += bits_;
+                        }
+
+                        if (!filled_)
+                            return std::optional<value_type>();
+                        uint64_t word = word_;
+                        word_ = 0;
+                        filled_ = 0;
+                        return std::optional<value_type>(word);
+                    }
+
+                private:
+                    unsigned bits_;
+                    BaseIterator base_;
+                    uint64_t word_;
+                    unsigned filled_;
+                    bool ended_;
+            };
+
+        /**
+         * Unpacks count values of bits bits written by bitpack. Whole blocks
+         * of 64 values go through a kernel specialized for the width, or the
+         * AVX2 / AVX-512 one when the host has them (see simd.hpp).
+         */
+        template<typename T>
+            class bitpacked_iterator {
+                public:
+                    typedef T value_type;
+
+                    bitpacked_iterator() = delete;
+                    bitpacked_iterator(const uint64_t* words, size_t count, unsigned bits)
+                        : words_(words), count_(count), bits_(std::min(bits, 64u)), unpack_(detail::unpack_kernel(bits_)), index_(0), pos_(0), size_(0) {}
+
+                    std::optional<value_type> next() {
+                        if (pos_ == size_) {
+                            if (index_ == count_)
+                                return std::optional<value_type>();
+                            size_ = std::min<size_t>(64, count_ - index_);
+                            if (size_ == 64)
+                                unpack_(words_ + index_ / 64 * bits_, block_, bits_);
+                            else
+                                for (size_t k = 0; k < size_; k++)
+                                    block_[k] = detail::unpack_one(words_, index_ + k, bits_);
+                            index_ += size_;
+                            pos_ = 0;
+                        }
+                        return std::optional<value_type>(static_cast<value_type>(block_[pos_++]));
+                    }
+
+                private:
+                    const uint64_t* words_;
+                    size_t count_;
+                    unsigned bits_;
+                    detail::unpack_block_func unpack_;
+                    size_t index_;
+                    uint64_t block_[64];
+                    size_t pos_;
+                    size_t size_;
+            };
+    }
+
+	namespace from {
+
+		using namespace lazypp::iterators;
+
+		template<typename T>
+			auto varint(const uint8_t* data, size_t size) {
+				return wrap(varint_iterator<T>(data, data + size));
+			}
+
+		template<typename T>
+			auto varint(const std::vector<uint8_t>& bytes) {
+				return varint<T>(bytes.data(), bytes.size());
+			}
+
+		/**
+		 * count values of bits bits packed by bitpack.
+		 */
+		template<typename T>
+			auto bitpacked(const uint64_t* words, size_t count, unsigned bits) {
+				return wrap(bitpacked_iterator<T>(words, count, bits));
+			}
+
+		template<typename T>
+			auto bitpacked(const std::vector<uint64_t>& words, size_t count, unsigned bits) {
+				return bitpacked<T>(words.data(), count, bits);
+			}
+	}
+}
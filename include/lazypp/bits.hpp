@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ * Bit twiddling, hashing and varint helpers shared by the other headers.
+ */
+
+#include "config.hpp"
+
+#include <array>
+#include <utility>
+
+namespace lazypp {
+
+    namespace detail {
+        /**
+         * SplitMix64 finalizer: a bijective mix of all 64 bits.
+         */
+        constexpr uint64_t mix64(uint64_t x) {
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+
+        inline constexpr uint64_t golden_gamma = 0x9e3779b97f4a7c15ull;
+
+        template<typename T>
+            constexpr T to_unit(uint64_t bits) {
+                return T(bits >> 11) * T(1.0 / 9007199254740992.0);
+            }
+
+        template<>
+            constexpr float to_unit<float>(uint64_t bits) {
+                return float(bits >> 40) * (1.0f / 16777216.0f);
+            }
+
+        /**
+         * High 64 bits of the 128 bit product a * b.
+         */
+        constexpr uint64_t mul_high64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+            return uint64_t((unsigned __int128)a * b >> 64);
+#else
+            const uint64_t a_lo = a & 0xffffffffull, a_hi = a >> 32;
+            const uint64_t b_lo = b & 0xffffffffull, b_hi = b >> 32;
+            const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+            const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffffull) + lo_hi;
+            return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+        }
+
+        /**
+         * w must not be 0.
+         */
+        inline unsigned count_trailing_zeros(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(w);
+#else
+            unsigned n = 0;
+            for (; !(w & 1); w >>= 1)
+                n++;
+            return n;
+#endif
+        }
+
+        /**
+         * Bit i of the result is the xor of bits 0..i of x.
+         */
+        inline uint64_t prefix_xor(uint64_t x) {
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+        }
+
+        constexpr uint64_t zigzag_encode(int64_t v) {
+            return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+        }
+
+        constexpr int64_t zigzag_decode(uint64_t v) {
+            return int64_t(v >> 1) ^ -int64_t(v & 1);
+        }
+
+        /**
+         * LEB128: 7 bits per byte, high bit set on all bytes but the last.
+         * Writes at most 10 bytes, returns the number written.
+         */
+        inline size_t put_varint(uint64_t v, uint8_t* out) {
+            size_t n = 0;
+            while (v >= 0x80) {
+                out[n++] = uint8_t(v) | 0x80;
+                v >>= 7;
+            }
+            out[n++] = uint8_t(v);
+            return n;
+        }
+
+        /**
+         * Reads one varint at p, advancing it. Returns false on a truncated
+         * or overlong value.
+         */
+        inline bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+            v = 0;
+            for (unsigned shift = 0; p < end && shift < 64; shift += 7) {
+                uint8_t byte = *p++;
+                v |= uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * Integers are stored zigzag encoded as varints, so small negative
+         * values (frequent after delta encoding) stay short.
+         */
+        template<typename T>
+            constexpr uint64_t to_varint_value(T v) {
+                return std::is_signed<T>::value ? zigzag_encode(int64_t(v)) : uint64_t(v);
+            }
+
+        template<typename T>
+            constexpr T from_varint_value(uint64_t v) {
+                return std::is_signed<T>::value ? T(zigzag_decode(v)) : T(v);
+            }
+
+        /**
+         * Varint of the difference v - previous. It is taken modulo 2^bits
+         * of T in the unsigned type, so it never overflows, and zigzag
+         * encoded at that width so small steps either way stay short.
+         */
+        template<typename T>
+            constexpr uint64_t to_delta_varint_value(T v, T previous) {
+                typedef std::make_unsigned_t<std::conditional_t<std::is_same<T, bool>::value, unsigned char, T>> U;
+                U delta = U(U(v) - U(previous));
+                return uint64_t(U(U(delta << 1) ^ U(U(0) - U(delta >> (sizeof(U) * 8 - 1)))));
+            }
+
+        template<typename T>
+            constexpr T from_delta_varint_value(uint64_t v, T previous) {
+                typedef std::make_unsigned_t<std::conditional_t<std::is_same<T, bool>::value, unsigned char, T>> U;
+                U delta = U(U(U(v) >> 1) ^ U(U(0) - U(v & 1)));
+                return T(U(U(previous) + delta));
+            }
+
+        constexpr uint64_t low_bits_mask(unsigned bits) {
+            return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+        }
+
+        /**
+         * Value k of a stream of bits wide values packed little endian in
+         * 64 bit words (values may straddle two words).
+         */
+        inline uint64_t unpack_one(const uint64_t* words, size_t k, unsigned bits) {
+            if (!bits)
+                return 0;
+            size_t bit = k * bits;
+            unsigned offset = bit % 64;
+            uint64_t v = words[bit / 64] >> offset;
+            if (offset + bits > 64)
+                v |= words[bit / 64 + 1] << (64 - offset);
+            return v & low_bits_mask(bits);
+        }
+
+        /**
+         * Unpacks 64 values of Bits bits, which take exactly Bits words.
+         * Shifts and masks are constants once the loop is unrolled. bits is
+         * Bits, for the signature shared with the vector kernels of simd.hpp.
+         */
+        template<unsigned Bits>
+            void unpack_block(const uint64_t* words, uint64_t* out, unsigned) {
+                for (unsigned k = 0; k < 64; k++)
+                    out[k] = unpack_one(words, k, Bits);
+            }
+
+        typedef void (*unpack_block_func)(const uint64_t*, uint64_t*, unsigned);
+
+        template<unsigned... Bits>
+            constexpr std::array<unpack_block_func, sizeof...(Bits)> make_unpack_table(std::integer_sequence<unsigned, Bits...>) {
+                return {{&unpack_block<Bits>...}};
+            }
+
+        inline const std::array<unpack_block_func, 65>& unpack_table() {
+            static constexpr std::array<unpack_block_func, 65> table = make_unpack_table(std::make_integer_sequence<unsigned, 65>());
+            return table;
+        }
+    }
+}
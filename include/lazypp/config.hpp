@@ -0,0 +1,45 @@
+#pragma once
+
+/**
+ * Standard features and macros every lazypp header relies on.
+ */
+
+#include <type_traits>
+#if __cplusplus >= 201703L && __has_include(<optional>)
+#include <optional>
+#else
+#include <experimental/optional>
+#endif
+#include <cstddef>
+#include <cstdint>
+
+#if !(__cplusplus >= 201703L && __has_include(<optional>))
+namespace std {
+    template<typename T>
+        using optional = std::experimental::optional<T>;
+}
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LAZYPP_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define LAZYPP_PREFETCH(addr) ((void)(addr))
+#endif
+
+/**
+ * Per element glue (next(), stage application...), inlined even in -O0
+ * debug builds where every one of these calls would otherwise be real.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define LAZYPP_INLINE __attribute__((always_inline)) inline
+#define LAZYPP_INLINE_LAMBDA __attribute__((always_inline))
+#else
+#define LAZYPP_INLINE inline
+#define LAZYPP_INLINE_LAMBDA
+#endif
+
+#ifdef BOOST_HAS_CONCEPTS
+#define IF_HAS_CONCEPTS(x) x
+#else
+#define IF_HAS_CONCEPTS(x)
+#endif
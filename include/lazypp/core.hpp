@@ -0,0 +1,1428 @@
+#pragma once
+
+/**
+ * The budget, result and stage types, the core iterators (map, filter,
+ * take...), the wrapper and the from:: sources over functions, ranges and
+ * STL containers. Every other lazypp header builds on this one.
+ */
+
+#include "config.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lazypp {
+
+    class memory_budget_exceeded : public std::runtime_error {
+        public:
+            memory_budget_exceeded(size_t requested, size_t used, size_t limit)
+                : std::runtime_error("lazypp: memory budget exceeded (" + std::to_string(requested) + " bytes requested, "
+                        + std::to_string(used) + " of " + std::to_string(limit) + " in use)") {}
+    };
+
+    /**
+     * Bytes held by the buffering stages of a pipeline (prefetch rings,
+     * decompression blocks, line assembly buffers...). Reserving past the
+     * limit throws memory_budget_exceeded, none of the stages can spill.
+     * Thread safe, stages running on background threads share it.
+     */
+    class memory_budget {
+        public:
+            explicit memory_budget(size_t limit = std::numeric_limits<size_t>::max()) : limit_(limit), used_(0), peak_(0) {}
+
+            void reserve(size_t bytes) {
+                size_t used = used_.fetch_add(bytes) + bytes;
+                if (used > limit_ || used < bytes) {
+                    used_.fetch_sub(bytes);
+                    throw memory_budget_exceeded(bytes, used - bytes, limit_);
+                }
+                size_t peak = peak_.load();
+                while (used > peak && !peak_.compare_exchange_weak(peak, used))
+                    ;
+            }
+
+            void release(size_t bytes) {
+                used_.fetch_sub(bytes);
+            }
+
+            size_t used() const {
+                return used_.load();
+            }
+
+            size_t peak() const {
+                return peak_.load();
+            }
+
+            size_t limit() const {
+                return limit_;
+            }
+
+        private:
+            size_t limit_;
+            std::atomic<size_t> used_;
+            std::atomic<size_t> peak_;
+    };
+
+    /**
+     * Error of a result, built with failure(e) much like std::unexpected.
+     */
+    template<typename E>
+        class failure {
+            public:
+                constexpr explicit failure(E error) : error_(std::move(error)) {}
+
+                constexpr E& error() noexcept {
+                    return error_;
+                }
+
+            private:
+                E error_;
+        };
+
+    /**
+     * Either a value or an error, for functions that fail on some of their
+     * inputs without throwing (see wrapper::try_map). Holds no more than a
+     * std::variant<T, E>: checking it is a single compare, and nothing is
+     * allocated unless T or E do.
+     */
+    template<typename T, typename E>
+        class result {
+            public:
+                typedef T value_type;
+                typedef E error_type;
+
+                constexpr result(T value) : state_(std::in_place_index<0>, std::move(value)) {}
+
+                template<typename F>
+                    constexpr result(failure<F> f) : state_(std::in_place_index<1>, std::move(f.error())) {}
+
+                constexpr bool has_value() const noexcept {
+                    return state_.index() == 0;
+                }
+
+                constexpr explicit operator bool() const noexcept {
+                    return has_value();
+                }
+
+                constexpr T& value() noexcept {
+                    return *std::get_if<0>(&state_);
+                }
+
+                constexpr const T& value() const noexcept {
+                    return *std::get_if<0>(&state_);
+                }
+
+                constexpr T& operator*() noexcept {
+                    return value();
+                }
+
+                constexpr const T& operator*() const noexcept {
+                    return value();
+                }
+
+                constexpr T* operator->() noexcept {
+                    return &value();
+                }
+
+                constexpr const T* operator->() const noexcept {
+                    return &value();
+                }
+
+                constexpr E& error() noexcept {
+                    return *std::get_if<1>(&state_);
+                }
+
+                constexpr const E& error() const noexcept {
+                    return *std::get_if<1>(&state_);
+                }
+
+            private:
+                std::variant<T, E> state_;
+        };
+
+    namespace detail {
+        template<typename T>
+            struct is_result : std::false_type {};
+
+        template<typename T, typename E>
+            struct is_result<result<T, E>> : std::true_type {};
+
+        /**
+         * f(std::move(v)) when f takes an rvalue, f(v) when it can only
+         * take v by non-const reference (to change it in place).
+         */
+        template<typename Func, typename T>
+            LAZYPP_INLINE constexpr decltype(auto) call_moving(Func& f, T& v) {
+                if constexpr (std::is_invocable_v<Func&, T&&>)
+                    return f(std::move(v));
+                else
+                    return f(v);
+            }
+
+        /**
+         * Bytes a stage holds against an optional budget. Copies reserve
+         * their own bytes since they hold their own buffers, moves carry
+         * the bytes over with the buffers.
+         */
+        class memory_reservation {
+            public:
+                memory_reservation() : bytes_(0) {}
+                memory_reservation(const memory_reservation& r) : budget_(r.budget_), bytes_(0) {
+                    resize(r.bytes_);
+                }
+                memory_reservation(memory_reservation&& r) noexcept : budget_(std::move(r.budget_)), bytes_(r.bytes_) {
+                    r.bytes_ = 0;
+                }
+
+                memory_reservation& operator=(const memory_reservation& r) {
+                    resize(0);
+                    budget_ = r.budget_;
+                    resize(r.bytes_);
+                    return *this;
+                }
+
+                memory_reservation& operator=(memory_reservation&& r) noexcept {
+                    resize(0);
+                    budget_ = std::move(r.budget_);
+                    bytes_ = r.bytes_;
+                    r.bytes_ = 0;
+                    return *this;
+                }
+
+                ~memory_reservation() {
+                    resize(0);
+                }
+
+                void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                    size_t bytes = bytes_;
+                    resize(0);
+                    budget_ = budget;
+                    resize(bytes);
+                }
+
+                const std::shared_ptr<memory_budget>& budget() const {
+                    return budget_;
+                }
+
+                void resize(size_t bytes) {
+                    if (budget_) {
+                        if (bytes > bytes_)
+                            budget_->reserve(bytes - bytes_);
+                        else
+                            budget_->release(bytes_ - bytes);
+                    }
+                    bytes_ = bytes;
+                }
+
+            private:
+                std::shared_ptr<memory_budget> budget_;
+                size_t bytes_;
+        };
+
+        template<typename Iterator, typename = void>
+            struct has_set_budget : std::false_type {};
+
+        template<typename Iterator>
+            struct has_set_budget<Iterator, std::void_t<decltype(std::declval<Iterator&>().set_budget(std::declval<const std::shared_ptr<memory_budget>&>()))>>
+                : std::true_type {};
+
+        template<typename Iterator>
+            void set_budget(Iterator& iterator, const std::shared_ptr<memory_budget>& budget) {
+                if constexpr (has_set_budget<Iterator>::value)
+                    iterator.set_budget(budget);
+            }
+    }
+
+    /**
+     * Element encoding of the write_binary format. varint and delta_varint
+     * are only available for integers: each value (or its difference with
+     * the previous one) is stored as a zigzag varint.
+     */
+    enum class binary_encoding : uint8_t {
+        raw = 0,
+        varint = 1,
+        delta_varint = 2
+    };
+
+    namespace detail {
+        template<size_t I, typename Stage>
+            struct stage_slot {
+                Stage stage;
+            };
+
+        /**
+         * Flat storage of a staged_iterator, the source in slot 0 followed by
+         * the stages. Unlike std::tuple it instantiates no recursive chain of
+         * bases and, being an aggregate, no constructors of its own.
+         */
+        template<typename Indices, typename... Stages>
+            struct stage_slots;
+
+        template<size_t... I, typename... Stages>
+            struct stage_slots<std::index_sequence<I...>, Stages...> : stage_slot<I, Stages>... {};
+
+        template<size_t I, typename Stage>
+            LAZYPP_INLINE constexpr Stage& slot_get(stage_slot<I, Stage>& slot) {
+                return slot.stage;
+            }
+
+        template<typename T, typename Stage>
+            using stage_result = typename decltype(std::declval<Stage&>().apply(std::declval<T>(), std::declval<bool&>()))::value_type;
+
+        /**
+         * Value type of T passed through Stages, and whether none of them can
+         * throw on the way.
+         */
+        template<typename T, typename... Stages>
+            struct staged_value {
+                typedef T type;
+                static constexpr bool nothrow = true;
+            };
+
+        template<typename T, typename Stage, typename... Stages>
+            struct staged_value<T, Stage, Stages...> : staged_value<stage_result<T, Stage>, Stages...> {
+                static constexpr bool nothrow = noexcept(std::declval<Stage&>().apply(std::declval<T>(), std::declval<bool&>()))
+                    && staged_value<stage_result<T, Stage>, Stages...>::nothrow;
+            };
+
+        /**
+         * Whether next() of Iterator can't throw, the noexcept of every stage
+         * derives from the one of its base and of the user functions.
+         */
+        template<typename Iterator>
+            constexpr bool nothrow_next = noexcept(std::declval<Iterator&>().next());
+
+        struct any_sink {
+            template<typename T>
+                constexpr bool operator()(T&&) const { return true; }
+        };
+
+        /**
+         * Iterators with drain(sink) push all their elements to sink, as
+         * rvalues, until they run out or sink returns false. Terminals use it
+         * instead of next() when they can: no optional is built per element,
+         * and the stages nest into a single loop, so debug builds make few
+         * calls per element.
+         */
+        template<typename Iterator, typename = void>
+            struct has_drain : std::false_type {};
+
+        template<typename Iterator>
+            struct has_drain<Iterator, std::void_t<decltype(std::declval<Iterator&>().drain(std::declval<any_sink&>()))>> : std::true_type {};
+
+        /**
+         * size elements stored one after the other at data.
+         */
+        template<typename T>
+            struct span {
+                const T* data;
+                size_t size;
+            };
+
+        /**
+         * Iterators with next_span(max) hand out their elements as spans of
+         * at most max elements, empty at the end, valid until the next call.
+         * map_batch passes them to its kernel without copying.
+         */
+        template<typename Iterator, typename = void>
+            struct has_next_span : std::false_type {};
+
+        template<typename Iterator>
+            struct has_next_span<Iterator, std::void_t<decltype(std::declval<Iterator&>().next_span(size_t()))>> : std::true_type {};
+
+        /**
+         * Iterators over elements contiguous in memory. Without C++20 only
+         * pointers and the iterators of libstdc++'s vector and string are
+         * recognized.
+         */
+        template<typename It>
+            struct is_contiguous : std::is_pointer<It> {};
+
+#if defined(__cpp_lib_concepts)
+        template<typename It> requires std::contiguous_iterator<It>
+            struct is_contiguous<It> : std::true_type {};
+#elif defined(__GLIBCXX__)
+        template<typename T, typename Container>
+            struct is_contiguous<__gnu_cxx::__normal_iterator<T*, Container>> : std::true_type {};
+#endif
+    }
+
+    /**
+     * Stages for wrapper::staged(). They depend on their function only: apply
+     * deduces the element type and returns v, transformed or not, or nothing
+     * if it is dropped, and sets done once no further element can get through.
+     */
+    namespace stage {
+        template<typename MapFunc>
+            class map {
+                public:
+                    constexpr map(MapFunc map_func) : map_func_(map_func) {}
+
+                    constexpr bool exhausted() const {
+                        return false;
+                    }
+
+                    template<typename T>
+                        LAZYPP_INLINE constexpr std::optional<std::result_of_t<MapFunc(T)>> apply(T&& v, bool&)
+                            noexcept(std::is_nothrow_invocable_v<MapFunc&, std::remove_reference_t<T>&&> && std::is_nothrow_move_constructible_v<std::result_of_t<MapFunc(T)>>) {
+                            return map_func_(std::move(v));
+                        }
+
+                private:
+                    MapFunc map_func_;
+            };
+
+        template<typename FilterFunc>
+            class filter {
+                public:
+                    constexpr filter(FilterFunc filter_func) : filter_func_(filter_func) {}
+
+                    constexpr bool exhausted() const {
+                        return false;
+                    }
+
+                    template<typename T>
+                        LAZYPP_INLINE constexpr std::optional<T> apply(T&& v, bool&)
+                            noexcept(std::is_nothrow_invocable_v<FilterFunc&, T&> && std::is_nothrow_move_constructible_v<T>) {
+                            if (filter_func_(v))
+                                return std::move(v);
+                            return std::optional<T>();
+                        }
+
+                private:
+                    FilterFunc filter_func_;
+            };
+
+        class take {
+            public:
+                constexpr take(size_t num) : num_(num) {}
+
+                constexpr bool exhausted() const {
+                    return num_ == 0;
+                }
+
+                template<typename T>
+                    LAZYPP_INLINE constexpr std::optional<T> apply(T&& v, bool& done) noexcept(std::is_nothrow_move_constructible_v<T>) {
+                        // stop right after the last element, without pulling
+                        // one more from the source
+                        if (--num_ == 0)
+                            done = true;
+                        return std::move(v);
+                    }
+
+            private:
+                size_t num_;
+        };
+
+        template<typename TestFunc>
+            class take_while {
+                public:
+                    constexpr take_while(TestFunc test_func) : test_func_(test_func) {}
+
+                    constexpr bool exhausted() const {
+                        return false;
+                    }
+
+                    template<typename T>
+                        LAZYPP_INLINE constexpr std::optional<T> apply(T&& v, bool& done)
+                            noexcept(std::is_nothrow_invocable_v<TestFunc&, T&> && std::is_nothrow_move_constructible_v<T>) {
+                            if (test_func_(v))
+                                return std::move(v);
+                            done = true;
+                            return std::optional<T>();
+                        }
+
+                private:
+                    TestFunc test_func_;
+            };
+    }
+
+    namespace iterators {
+        IF_HAS_CONCEPTS(
+        template<typename T>
+            concept bool LazyIterator = requires(T a) {
+                typename T::value_type;
+                T(a);
+                { a.next() } -> typename std::optional<typename T::value_type>;
+            };
+            )
+
+        /**
+         * each iterator should define:
+         *  value_type
+         */
+        template<typename BaseIterator, typename MapFunc> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class map_iterator {
+                public:
+                    typedef typename BaseIterator::value_type base_value_type;
+                    typedef typename std::result_of_t<MapFunc(base_value_type)> value_type;
+                    typedef map_iterator<BaseIterator, MapFunc> iterator;
+
+                    map_iterator() = delete;
+                    constexpr map_iterator(MapFunc map_func, BaseIterator base) : map_func_(map_func), base_(base) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next()
+                        noexcept(detail::nothrow_next<BaseIterator> && std::is_nothrow_invocable_v<MapFunc&, base_value_type&&>
+                                && std::is_nothrow_move_constructible_v<value_type>) {
+                        auto v = base_.next();
+                        if (v)
+                            return std::optional<value_type>(map_func_(std::move(*v)));
+                        else
+                            return std::optional<value_type>();
+                    }
+
+
+                    template<typename Sink, typename B = BaseIterator>
+                        LAZYPP_INLINE constexpr auto drain(Sink&& sink) -> decltype(std::declval<B&>().drain(std::declval<detail::any_sink&>())) {
+                            base_.drain([this, &sink](auto&& v) LAZYPP_INLINE_LAMBDA { return sink(map_func_(std::move(v))); });
+                        }
+
+                    /**
+                     * Elements left, when the base knows it.
+                     */
+                    template<typename B = BaseIterator>
+                        constexpr auto size() const -> decltype(std::declval<const B&>().size()) {
+                            return base_.size();
+                        }
+
+                private:
+                    MapFunc map_func_;
+                    BaseIterator base_;
+            };
+
+        template<typename BaseIterator, typename FilterFunc> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class filter_iterator {
+                public:
+                    typedef typename BaseIterator::value_type value_type;
+
+                    filter_iterator() = delete;
+                    constexpr filter_iterator(FilterFunc filter_func, BaseIterator base) : filter_func_(filter_func), base_(base) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next()
+                        noexcept(detail::nothrow_next<BaseIterator> && std::is_nothrow_invocable_v<FilterFunc&, value_type&>) {
+                        // a fresh optional per element: assigning to an engaged one
+                        // would assign through reference members (e.g. matrix cells)
+                        while (true) {
+                            auto v = base_.next();
+                            if (!v || filter_func_(*v))
+                                return v;
+                        }
+                    }
+
+                    template<typename Sink, typename B = BaseIterator>
+                        LAZYPP_INLINE constexpr auto drain(Sink&& sink) -> decltype(std::declval<B&>().drain(std::declval<detail::any_sink&>())) {
+                            base_.drain([this, &sink](auto&& v) LAZYPP_INLINE_LAMBDA { return !filter_func_(v) || sink(std::move(v)); });
+                        }
+
+                private:
+                    FilterFunc filter_func_;
+                    BaseIterator base_;
+            };
+
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class take_iterator {
+                public:
+                    typedef typename BaseIterator::value_type value_type;
+
+                    take_iterator() = delete;
+                    constexpr take_iterator(size_t num, BaseIterator base) : num_(num), base_(base) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next() noexcept(detail::nothrow_next<BaseIterator>) {
+                        if (num_) {
+                            num_--;
+                            return base_.next();
+                        }
+                        else
+                            return std::optional<value_type>();
+                    }
+
+                    template<typename Sink, typename B = BaseIterator>
+                        LAZYPP_INLINE constexpr auto drain(Sink&& sink) -> decltype(std::declval<B&>().drain(std::declval<detail::any_sink&>())) {
+                            if (num_ == 0)
+                                return;
+                            base_.drain([this, &sink](auto&& v) LAZYPP_INLINE_LAMBDA {
+                                    num_--;
+                                    return sink(std::move(v)) && num_ != 0;
+                                });
+                        }
+
+                    template<typename B = BaseIterator>
+                        constexpr auto size() const -> decltype(size_t(std::declval<const B&>().size())) {
+                            return std::min(num_, size_t(base_.size()));
+                        }
+
+                private:
+                    size_t num_;
+                    BaseIterator base_;
+            };
+
+        template<typename GenFunc>
+            class generate_iterator {
+                public:
+                    typedef std::result_of_t<GenFunc()> value_type;
+
+                    generate_iterator() = delete;
+                    constexpr generate_iterator(const GenFunc gen_func) : gen_func_(gen_func) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next()
+                        noexcept(std::is_nothrow_invocable_v<GenFunc&> && std::is_nothrow_move_constructible_v<value_type>) {
+                        return std::optional<value_type>(gen_func_());
+                    }
+
+                    template<typename Sink>
+                        LAZYPP_INLINE constexpr void drain(Sink&& sink) {
+                            while (sink(gen_func_()))
+                                ;
+                        }
+
+                private:
+                    GenFunc gen_func_;
+            };
+
+        template<typename BaseIterator, typename TestFunc> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class take_while_iterator {
+                public:
+                    typedef typename BaseIterator::value_type value_type;
+
+                    take_while_iterator() = delete;
+                    constexpr take_while_iterator(TestFunc test_func, BaseIterator base) : test_func_(test_func), base_(base), ended_(false) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next()
+                        noexcept(detail::nothrow_next<BaseIterator> && std::is_nothrow_invocable_v<TestFunc&, value_type&>) {
+                        if (ended_)
+                            return std::optional<value_type>();
+
+                        auto v = base_.next();
+                        if (v && test_func_(*v))
+                            return v;
+
+                        ended_ = true;
+                        return std::optional<value_type>();
+                    }
+
+                    template<typename Sink, typename B = BaseIterator>
+                        LAZYPP_INLINE constexpr auto drain(Sink&& sink) -> decltype(std::declval<B&>().drain(std::declval<detail::any_sink&>())) {
+                            if (ended_)
+                                return;
+                            base_.drain([this, &sink](auto&& v) LAZYPP_INLINE_LAMBDA {
+                                    if (!test_func_(v)) {
+                                        ended_ = true;
+                                        return false;
+                                    }
+                                    return sink(std::move(v));
+                                });
+                        }
+
+                private:
+                    TestFunc test_func_;
+                    BaseIterator base_;
+                    bool ended_;
+            };
+
+
+        /**
+         * Source followed by a flat list of stages driven by a single loop.
+         * Nesting map_iterator<filter_iterator<take_iterator<...>>> adds a
+         * type, with its own constructors, next() and wrapper, per stage,
+         * each one spelling out all the inner ones; here the whole pipeline
+         * is one type. Built with wrapper::staged().
+         */
+        template<typename Source, typename... Stages> IF_HAS_CONCEPTS(requires LazyIterator<Source>)
+            class staged_iterator {
+                public:
+                    typedef typename detail::staged_value<typename Source::value_type, Stages...>::type value_type;
+
+                    staged_iterator() = delete;
+                    constexpr staged_iterator(Source source, Stages... stages)
+                        : stages_{{source}, {stages}...}, done_((stages.exhausted() || ... || false)) {}
+
+                    LAZYPP_INLINE constexpr std::optional<value_type> next()
+                        noexcept(detail::nothrow_next<Source> && detail::staged_value<typename Source::value_type, Stages...>::nothrow
+                                && std::is_nothrow_move_constructible_v<value_type>) {
+                        std::optional<value_type> out;
+                        while (!out && !done_) {
+                            auto v = detail::slot_get<0>(stages_).next();
+                            if (!v) {
+                                done_ = true;
+                                break;
+                            }
+                            push<1>(std::move(*v), out);
+                        }
+                        return out;
+                    }
+
+                    template<typename Sink>
+                        LAZYPP_INLINE constexpr void drain(Sink&& sink) {
+                            if (done_)
+                                return;
+                            auto& source = detail::slot_get<0>(stages_);
+                            if constexpr (detail::has_drain<Source>::value)
+                                source.drain([this, &sink](auto&& v) LAZYPP_INLINE_LAMBDA { return feed<1>(std::move(v), sink); });
+                            else
+                                while (true) {
+                                    auto v = source.next();
+                                    if (!v || !feed<1>(std::move(*v), sink))
+                                        break;
+                                }
+                            done_ = true;
+                        }
+
+                    void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                        detail::set_budget(detail::slot_get<0>(stages_), budget);
+                    }
+
+                private:
+                    // drain's counterpart of push: false once nothing more is wanted
+                    template<size_t I, typename T, typename Sink>
+                        LAZYPP_INLINE constexpr bool feed(T&& v, Sink& sink) {
+                            if constexpr (I > sizeof...(Stages))
+                                return sink(std::move(v));
+                            else {
+                                auto r = detail::slot_get<I>(stages_).apply(std::move(v), done_);
+                                return (!r || feed<I + 1>(std::move(*r), sink)) && !done_;
+                            }
+                        }
+
+                    template<size_t I, typename T>
+                        LAZYPP_INLINE constexpr void push(T&& v, std::optional<value_type>& out) {
+                            if constexpr (I > sizeof...(Stages))
+                                out.emplace(std::move(v));
+                            else {
+                                auto r = detail::slot_get<I>(stages_).apply(std::move(v), done_);
+                                if (r)
+                                    push<I + 1>(std::move(*r), out);
+                            }
+                        }
+
+                    detail::stage_slots<std::make_index_sequence<sizeof...(Stages) + 1>, Source, Stages...> stages_;
+                    bool done_;
+            };
+
+        /**
+         * map for functions returning a result. Over a pipeline of results
+         * func only sees the values, errors are passed through untouched.
+         */
+        template<typename BaseIterator, typename Func> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class try_map_iterator {
+                public:
+                    typedef typename BaseIterator::value_type base_value_type;
+                    typedef typename std::conditional_t<detail::is_result<base_value_type>::value,
+                            std::result_of<Func(typename base_value_type::value_type)>,
+                            std::result_of<Func(base_value_type)>>::type value_type;
+
+                    static_assert(detail::is_result<value_type>::value, "try_map needs a function returning a lazypp::result");
+
+                    try_map_iterator() = delete;
+                    constexpr try_map_iterator(Func func, BaseIterator base) : func_(func), base_(base) {}
+
+                    constexpr std::optional<value_type> next() {
+                        auto v = base_.next();
+                        if (!v)
+                            return std::optional<value_type>();
+                        if constexpr (detail::is_result<base_value_type>::value) {
+                            if (!*v)
+                                return std::optional<value_type>(failure(std::move(v->error())));
+                            return std::optional<value_type>(func_(std::move(**v)));
+                        }
+                        else
+                            return std::optional<value_type>(func_(std::move(*v)));
+                    }
+
+                    template<typename B = BaseIterator>
+                        constexpr auto size() const -> decltype(std::declval<const B&>().size()) {
+                            return base_.size();
+                        }
+
+                private:
+                    Func func_;
+                    BaseIterator base_;
+            };
+
+        /**
+         * The values of a pipeline of results. Errors are dropped, or appended
+         * to errors when given.
+         */
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class ok_iterator {
+                public:
+                    typedef typename BaseIterator::value_type base_value_type;
+                    typedef typename base_value_type::value_type value_type;
+                    typedef typename base_value_type::error_type error_type;
+
+                    static_assert(detail::is_result<base_value_type>::value, "filter_ok needs a pipeline of lazypp::result");
+
+                    ok_iterator() = delete;
+                    constexpr ok_iterator(BaseIterator base, std::vector<error_type>* errors = nullptr) : base_(base), errors_(errors) {}
+
+                    constexpr std::optional<value_type> next() {
+                        while (true) {
+                            auto v = base_.next();
+                            if (!v)
+                                return std::optional<value_type>();
+                            if (*v)
+                                return std::optional<value_type>(std::move(**v));
+                            if (errors_)
+                                errors_->push_back(std::move(v->error()));
+                        }
+                    }
+
+                private:
+                    BaseIterator base_;
+                    std::vector<error_type>* errors_;
+            };
+
+		/**
+		 * FuncNext is a function that returns actual value and increment to the
+		 * next value.
+		 */
+		template<typename T, typename FuncLast, typename FuncNext>
+		class range_iterator {
+			public:
+				typedef T value_type;
+
+				range_iterator() = delete;
+				constexpr range_iterator(T first, FuncLast is_last, FuncNext func_next) : actual_(first), is_last_(is_last), func_next_(func_next) {}
+
+				LAZYPP_INLINE constexpr std::optional<value_type> next()
+					noexcept(std::is_nothrow_invocable_v<FuncLast&, T&> && std::is_nothrow_invocable_v<FuncNext&, T&>
+							&& std::is_nothrow_move_constructible_v<value_type>) {
+					if (is_last_(actual_))
+						return std::optional<value_type>();
+
+					return std::optional<value_type>(func_next_(actual_));
+				}
+
+				template<typename Sink>
+					LAZYPP_INLINE constexpr void drain(Sink&& sink) {
+						while (!is_last_(actual_))
+							if (!sink(func_next_(actual_)))
+								return;
+					}
+
+			private:
+				T actual_;
+				FuncLast is_last_;
+				FuncNext func_next_;
+		};
+
+		/**
+		 * [first, last) by increments of one, what from::range(begin, end)
+		 * returns: unlike range_iterator it calls no function per element,
+		 * which matters in debug builds.
+		 */
+		template<typename T>
+			class count_iterator {
+				public:
+					typedef T value_type;
+
+					count_iterator() = delete;
+					constexpr count_iterator(T first, T last) : actual_(first), last_(last) {}
+
+					LAZYPP_INLINE constexpr std::optional<value_type> next()
+						noexcept(noexcept(std::declval<T&>() == std::declval<T&>()) && noexcept(std::declval<T&>()++)
+								&& std::is_nothrow_move_constructible_v<value_type>) {
+						if (actual_ == last_)
+							return std::optional<value_type>();
+
+						return std::optional<value_type>(actual_++);
+					}
+
+					template<typename Sink>
+						LAZYPP_INLINE constexpr void drain(Sink&& sink) {
+							while (!(actual_ == last_))
+								if (!sink(actual_++))
+									return;
+						}
+
+					template<typename U = T>
+						constexpr std::enable_if_t<std::is_integral<U>::value, size_t> size() const {
+							return size_t(last_ - actual_);
+						}
+
+				private:
+					T actual_;
+					T last_;
+			};
+
+		template<typename STLIterator>
+			class stl_iterator {
+				public:
+					typedef typename std::iterator_traits<STLIterator>::value_type value_type;
+
+					stl_iterator() = delete;
+					constexpr stl_iterator(const STLIterator& first, const STLIterator& last) : actual_(first), last_(last) {}
+					constexpr stl_iterator(STLIterator&& first, STLIterator&& last) : actual_(std::move(first)), last_(std::move(last)) {}
+
+					LAZYPP_INLINE constexpr std::optional<value_type> next()
+						noexcept(noexcept(std::declval<STLIterator&>() == std::declval<STLIterator&>()) && noexcept(*std::declval<STLIterator&>()++)
+								&& std::is_nothrow_constructible_v<value_type, decltype(*std::declval<STLIterator&>()++)>) {
+						if (actual_ == last_)
+							return std::optional<value_type>();
+
+						return *actual_++;
+					}
+
+					template<typename Sink>
+						LAZYPP_INLINE constexpr void drain(Sink&& sink) {
+							while (!(actual_ == last_))
+								if (!sink(value_type(*actual_++)))
+									return;
+						}
+
+					template<typename I = STLIterator>
+						std::enable_if_t<std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<I>::iterator_category>::value, size_t>
+						constexpr size() const {
+							return size_t(last_ - actual_);
+						}
+
+					template<typename I = STLIterator>
+						std::enable_if_t<detail::is_contiguous<I>::value, detail::span<value_type>> next_span(size_t max) {
+							size_t n = std::min(max, size_t(last_ - actual_));
+							detail::span<value_type> s = {n ? std::addressof(*actual_) : nullptr, n};
+							actual_ += n;
+							return s;
+						}
+
+				private:
+					STLIterator actual_;
+					STLIterator last_;
+			};
+
+        template<typename T>
+        using stl_iterator_t = stl_iterator<std::remove_reference_t<T>>;
+
+        /**
+         * Defined by lazypp/algorithms.hpp, the wrapper methods using them
+         * (prefetch_ahead, gather, map_batch, the encoders) need it included.
+         */
+        template<typename BaseIterator, typename AddrFunc> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class prefetch_iterator;
+
+        template<typename BaseIterator, bool Decode> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class delta_iterator;
+
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class varint_encode_iterator;
+
+        template<typename BaseIterator, typename T> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class varint_decode_iterator;
+
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class bitpack_iterator;
+
+        template<typename BaseIterator, typename Kernel, typename T> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class map_batch_iterator;
+
+        template<typename Iterator> IF_HAS_CONCEPTS(requires LazyIterator<Iterator>)
+            class wrapper;
+    }
+
+    namespace detail {
+        /**
+         * Defined by lazypp/io.hpp, needed by write_binary and write_columnar.
+         */
+        template<typename T>
+            class binary_writer;
+
+        template<typename T>
+            class columnar_writer;
+
+        template<typename Iterator, typename = void>
+            struct has_size : std::false_type {};
+
+        template<typename Iterator>
+            struct has_size<Iterator, std::void_t<decltype(std::declval<const Iterator&>().size())>> : std::true_type {};
+
+        template<typename Container, typename = void>
+            struct has_reserve : std::false_type {};
+
+        template<typename Container>
+            struct has_reserve<Container, std::void_t<decltype(std::declval<Container&>().reserve(size_t()))>> : std::true_type {};
+
+        template<typename Iterator, typename Func, typename = void>
+            struct can_push_down : std::false_type {};
+
+        template<typename Iterator, typename Func>
+            struct can_push_down<Iterator, Func, std::void_t<decltype(std::declval<const Iterator&>().push_down(std::declval<Func>()))>>
+                : std::true_type {};
+    }
+
+    namespace where {
+        /**
+         * Defined by lazypp/strings.hpp, needed by the string stages.
+         */
+        class contains;
+        class starts_with;
+        class equals_any;
+        class matches_any;
+    }
+
+    namespace detail {
+        class match_tagger;
+    }
+
+    namespace iterators {
+
+        template<typename T>
+        using wrapper_t = wrapper<std::remove_reference_t<T>>;
+
+        template<typename T> IF_HAS_CONCEPTS(requires LazyIterator<T>)
+            constexpr wrapper_t<T> wrap(T&& t) {
+                return wrapper_t<T>(std::forward<T>(t));
+            }
+
+        template<typename Iterator> IF_HAS_CONCEPTS(requires LazyIterator<Iterator>)
+            class wrapper {
+                public:
+					typedef typename Iterator::value_type value_type;
+
+                    wrapper() = delete;
+                    wrapper(const wrapper<Iterator>&) = default;
+                    wrapper(wrapper<Iterator>&&) = default;
+                    wrapper<Iterator>& operator=(const wrapper<Iterator>&) = default;
+                    wrapper<Iterator>& operator=(wrapper<Iterator>&&) = default;
+                    constexpr wrapper(Iterator iterator) : iterator_(iterator) {}
+
+                    constexpr Iterator& iterator() {
+                        return iterator_;
+                    }
+
+                    /**
+                     * Accounts the buffers of the stages of this pipeline against
+                     * budget, failing with memory_budget_exceeded past its limit.
+                     * Call it on the source: the stages added afterwards share
+                     * the budget.
+                     */
+                    wrapper<Iterator> with_budget(const std::shared_ptr<memory_budget>& budget) {
+                        wrapper<Iterator> w(*this);
+                        w.budget_ = budget;
+                        detail::set_budget(w.iterator_, budget);
+                        return w;
+                    }
+
+                    wrapper<Iterator> with_budget(size_t limit = std::numeric_limits<size_t>::max()) {
+                        return with_budget(std::make_shared<memory_budget>(limit));
+                    }
+
+                    /**
+                     * Null unless with_budget was called.
+                     */
+                    const std::shared_ptr<memory_budget>& budget() const {
+                        static const std::shared_ptr<memory_budget> none;
+                        return budget_ ? *budget_ : none;
+                    }
+
+                    /**
+                     * Wraps a stage built on top of this pipeline, sharing its
+                     * budget.
+                     */
+                    template<typename T>
+                        constexpr wrapper<T> rewrap(T iterator) const {
+                            wrapper<T> w(iterator);
+                            if (budget_ && *budget_) {
+                                w.budget_ = budget_;
+                                detail::set_budget(w.iterator_, *budget_);
+                            }
+                            return w;
+                        }
+
+                    /**
+                     * The stages (see lazypp::stage) applied in order by a
+                     * single staged_iterator, an alternative to chaining map,
+                     * filter, take and take_while that instantiates one
+                     * iterator for the whole pipeline instead of one per call.
+                     */
+                    template<typename... Stages>
+                        constexpr wrapper<staged_iterator<Iterator, Stages...>> staged(Stages... stages) {
+                            return rewrap(staged_iterator<Iterator, Stages...>(iterator_, stages...));
+                        }
+
+                    template<typename Func>
+                        constexpr wrapper<map_iterator<Iterator, Func>> map(Func f) {
+                            return rewrap(map_iterator<Iterator, Func>(f, iterator_));
+                        }
+
+                    /**
+                     * Sources that can evaluate f themselves (a where:: predicate
+                     * on from::columnar) get it pushed down instead.
+                     */
+                    template<typename Func>
+                        constexpr auto filter(Func f) {
+                            if constexpr (detail::can_push_down<Iterator, Func>::value)
+                                return rewrap(iterator_.push_down(f));
+                            else
+                                return rewrap(filter_iterator<Iterator, Func>(f, iterator_));
+                        }
+
+                    /**
+                     * String filters (elements converting to std::string_view),
+                     * with the SIMD predicates of lazypp/strings.hpp: elements
+                     * containing needle, starting with prefix, or equal to one
+                     * of strings.
+                     */
+                    template<typename Needle>
+                        auto filter_contains(const Needle& needle) {
+                            return filter(where::contains(needle));
+                        }
+
+                    template<typename Prefix>
+                        auto filter_prefix(const Prefix& prefix) {
+                            return filter(where::starts_with(prefix));
+                        }
+
+                    template<typename Strings>
+                        auto filter_equals_any(const Strings& strings) {
+                            return filter(where::equals_any(strings));
+                        }
+
+                    template<typename String>
+                        auto filter_equals_any(std::initializer_list<String> strings) {
+                            return filter(where::equals_any(strings));
+                        }
+
+                    /**
+                     * Many patterns at once (lazypp/strings.hpp): patterns is a
+                     * lazypp::pattern_set or a range of strings to build one
+                     * from, each element is scanned once. match_any keeps the
+                     * elements containing a pattern, tag_matches yields
+                     * (element, ids of the patterns it contains) tuples.
+                     */
+                    template<typename Patterns>
+                        auto match_any(const Patterns& patterns) {
+                            return filter(where::matches_any(patterns));
+                        }
+
+                    template<typename String>
+                        auto match_any(std::initializer_list<String> patterns) {
+                            return filter(where::matches_any(patterns));
+                        }
+
+                    template<typename Patterns>
+                        auto tag_matches(const Patterns& patterns) {
+                            return map(detail::match_tagger(patterns));
+                        }
+
+                    template<typename String>
+                        auto tag_matches(std::initializer_list<String> patterns) {
+                            return map(detail::match_tagger(patterns));
+                        }
+
+                    constexpr wrapper<take_iterator<Iterator>> take(size_t num_elems) {
+                        return rewrap(take_iterator<Iterator>(num_elems, iterator_));
+                    }
+
+                    template<typename Func>
+                        constexpr wrapper<take_while_iterator<Iterator, Func>> take_while(Func f) {
+                            return rewrap(take_while_iterator<Iterator, Func>(f, iterator_));
+                        }
+
+                    /**
+                     * f returns a lazypp::result instead of throwing. Chained
+                     * after another try_map it only gets the values, the errors
+                     * go on unchanged.
+                     */
+                    template<typename Func>
+                        constexpr wrapper<try_map_iterator<Iterator, Func>> try_map(Func f) {
+                            return rewrap(try_map_iterator<Iterator, Func>(f, iterator_));
+                        }
+
+                    /**
+                     * The values of a pipeline of results, skipping the errors.
+                     */
+                    constexpr wrapper<ok_iterator<Iterator>> filter_ok() {
+                        return rewrap(ok_iterator<Iterator>(iterator_));
+                    }
+
+                    /**
+                     * As filter_ok, appending the errors to errors, which must
+                     * outlive the pipeline.
+                     */
+                    template<typename E>
+                        wrapper<ok_iterator<Iterator>> collect_errors(std::vector<E>& errors) {
+                            return rewrap(ok_iterator<Iterator>(iterator_, &errors));
+                        }
+
+                    template<typename Func>
+                        wrapper<prefetch_iterator<Iterator, Func>> prefetch_ahead(size_t distance, Func addr_func) {
+                            return rewrap(prefetch_iterator<Iterator, Func>(distance, addr_func, iterator_));
+                        }
+
+                    /**
+                     * Maps each index to table[index], prefetching the entries
+                     * distance elements ahead. table must outlive the pipeline.
+                     */
+                    template<typename Table>
+                        auto gather(const Table& table, size_t distance = 16) {
+                            const Table* t = &table;
+                            return prefetch_ahead(distance, [t](const value_type& i) { return &(*t)[i]; })
+                                .map([t](const value_type& i) { return (*t)[i]; });
+                        }
+
+                    /**
+                     * Applies kernel(const value_type* in, size_t n, T* out),
+                     * which writes out[0, n), to batches of up to batch_size
+                     * elements: for transforms already vectorized by hand or
+                     * done by a library routine. Contiguous sources (vectors,
+                     * arrays, a previous map_batch) are passed without a copy.
+                     */
+                    template<typename T = value_type, typename Kernel>
+                        wrapper<map_batch_iterator<Iterator, Kernel, T>> map_batch(Kernel kernel, size_t batch_size = 1024) {
+                            return rewrap(map_batch_iterator<Iterator, Kernel, T>(batch_size, kernel, iterator_));
+                        }
+
+                    wrapper<delta_iterator<Iterator, false>> encode_delta() {
+                        return rewrap(delta_iterator<Iterator, false>(iterator_));
+                    }
+
+                    wrapper<delta_iterator<Iterator, true>> decode_delta() {
+                        return rewrap(delta_iterator<Iterator, true>(iterator_));
+                    }
+
+                    wrapper<varint_encode_iterator<Iterator>> encode_varint() {
+                        return rewrap(varint_encode_iterator<Iterator>(iterator_));
+                    }
+
+                    template<typename T>
+                        wrapper<varint_decode_iterator<Iterator, T>> decode_varint() {
+                            return rewrap(varint_decode_iterator<Iterator, T>(iterator_));
+                        }
+
+                    /**
+                     * Keeps the low bits bits of each element, packed in 64 bit
+                     * words. Read them back with from::bitpacked.
+                     */
+                    wrapper<bitpack_iterator<Iterator>> bitpack(unsigned bits) {
+                        return rewrap(bitpack_iterator<Iterator>(bits, iterator_));
+                    }
+
+                    template<typename Func>
+                        constexpr void each(Func f) noexcept(detail::nothrow_next<Iterator> && noexcept(detail::call_moving(f, std::declval<value_type&>()))) {
+                            // elements are moved into f unless it takes them by reference
+                            if constexpr (detail::has_drain<Iterator>::value)
+                                iterator_.drain([&f](value_type&& v) LAZYPP_INLINE_LAMBDA {
+                                        detail::call_moving(f, v);
+                                        return true;
+                                    });
+                            else
+                                while (true) {
+                                    auto v = iterator_.next();
+                                    if (!v)
+                                        break;
+                                    detail::call_moving(f, *v);
+                                }
+                        }
+
+					template<typename To>
+						constexpr std::remove_reference_t<To> to() {
+							std::remove_reference_t<To> new_container;
+							// a single allocation when the number of elements is known
+							if constexpr (detail::has_size<Iterator>::value && detail::has_reserve<std::remove_reference_t<To>>::value)
+								new_container.reserve(iterator_.size());
+							if constexpr (detail::has_drain<Iterator>::value)
+								iterator_.drain([&new_container](value_type&& v) LAZYPP_INLINE_LAMBDA {
+										new_container.push_back(std::move(v));
+										return true;
+									});
+							else
+								while (true) {
+									auto v = iterator_.next();
+									if (!v)
+										break;
+									new_container.push_back(std::move(*v));
+								}
+							return To(std::move(new_container));
+						}
+
+					template<typename To, typename Func>
+						constexpr To fold(To acum, Func f) {
+							if constexpr (detail::has_drain<Iterator>::value)
+								iterator_.drain([&acum, &f](value_type&& v) LAZYPP_INLINE_LAMBDA {
+										acum = f(std::move(acum), std::move(v));
+										return true;
+									});
+							else
+								while (true) {
+									auto v = iterator_.next();
+									if (!v)
+										break;
+									acum = f(std::move(acum), std::move(*v));
+								}
+							return acum;
+						}
+
+					/**
+					 * fold over a pipeline of results, stopping at the first
+					 * error, which is returned instead.
+					 */
+					template<typename To, typename Func, typename V = value_type>
+						constexpr result<To, typename V::error_type> try_fold(To acum, Func f) {
+							while (true) {
+								auto v = iterator_.next();
+								if (!v)
+									return acum;
+								if (!*v)
+									return failure(std::move(v->error()));
+								acum = f(std::move(acum), std::move(**v));
+							}
+						}
+
+					/**
+					 * The values of a pipeline of results, or its first error.
+					 */
+					template<typename To, typename V = value_type>
+						result<std::remove_reference_t<To>, typename V::error_type> try_to() {
+							std::remove_reference_t<To> new_container;
+							while (true) {
+								auto v = iterator_.next();
+								if (!v)
+									return new_container;
+								if (!*v)
+									return failure(std::move(v->error()));
+								new_container.push_back(std::move(**v));
+							}
+						}
+
+					/**
+					 * The first error of a pipeline of results, if any.
+					 */
+					template<typename V = value_type>
+						constexpr std::optional<typename V::error_type> first_error() {
+							while (true) {
+								auto v = iterator_.next();
+								if (!v)
+									return std::optional<typename V::error_type>();
+								if (!*v)
+									return std::move(v->error());
+							}
+						}
+
+					/**
+					 * The first N elements, the rest of the array is value
+					 * initialized when there are fewer. Unlike to<>() it needs no
+					 * allocation, so tables can be built in constant expressions:
+					 *
+					 *   constexpr auto squares = from::range(0, 256).map(sq).to_array<256>();
+					 */
+					template<size_t N>
+						constexpr std::array<value_type, N> to_array() {
+							std::array<value_type, N> out{};
+							for (size_t i = 0; i < N; i++) {
+								auto v = iterator_.next();
+								if (!v)
+									break;
+								out[i] = std::move(*v);
+							}
+							return out;
+						}
+
+					/**
+					 * Materializes a sequence of indices into a dense bitmap of
+					 * num_bits bits (64 per word), indices out of range are ignored.
+					 */
+					std::vector<uint64_t> to_bitmap(size_t num_bits) {
+						std::vector<uint64_t> words((num_bits + 63) / 64);
+						each([&words, num_bits](auto i) {
+								size_t bit = static_cast<size_t>(i);
+								if (bit < num_bits)
+									words[bit / 64] |= uint64_t(1) << (bit % 64);
+							});
+						return words;
+					}
+
+					/**
+					 * Writes the sequence to path in the format read by
+					 * from::binary<value_type>, returns the number of elements.
+					 * Throws std::system_error on I/O errors. Needs lazypp/io.hpp,
+					 * path is anything a std::filesystem::path is built from.
+					 */
+					template<typename Path>
+						size_t write_binary(const Path& path, binary_encoding encoding = binary_encoding::raw) {
+							static_assert(std::is_trivially_copyable<value_type>::value, "write_binary needs trivially copyable elements");
+							if (encoding != binary_encoding::raw && !std::is_integral<value_type>::value)
+								throw std::invalid_argument("lazypp: varint encodings need integer elements");
+
+							detail::binary_writer<value_type> writer(path, encoding);
+							size_t count = 0;
+							each([&writer, &count](const value_type& v) {
+									writer.push(v);
+									count++;
+								});
+							writer.close();
+							return count;
+						}
+
+					/**
+					 * Writes the sequence to path in blocks of block_size values,
+					 * each one preceded by its min and max, in the format read by
+					 * from::columnar<value_type>. Returns the number of elements.
+					 * Needs lazypp/io.hpp, as write_binary.
+					 */
+					template<typename Path>
+						size_t write_columnar(const Path& path, size_t block_size = 4096) {
+							static_assert(std::is_arithmetic<value_type>::value, "write_columnar needs arithmetic elements");
+
+							detail::columnar_writer<value_type> writer(path, block_size);
+							size_t count = 0;
+							each([&writer, &count](const value_type& v) {
+									writer.push(v);
+									count++;
+								});
+							writer.close();
+							return count;
+						}
+
+                private:
+                    template<typename OtherIterator> IF_HAS_CONCEPTS(requires LazyIterator<OtherIterator>)
+                        friend class wrapper;
+
+                    Iterator iterator_;
+                    // an optional keeps wrapper a literal type while no budget is set
+                    std::optional<std::shared_ptr<memory_budget>> budget_;
+            };
+	}
+
+	namespace from {
+
+		using namespace lazypp::iterators;
+
+        template<typename Func>
+            constexpr auto generator(Func f) {
+                return wrap(generate_iterator<Func>(f));
+            }
+
+		template<typename T, typename LastFunc, typename NextFunc>
+			constexpr auto range(T& begin, LastFunc last_func, NextFunc next_func) {
+				return wrap(range_iterator<T, LastFunc, NextFunc>(begin, last_func, next_func));
+			}
+
+		template<typename T>
+			constexpr auto range(T begin, T end) {
+				return wrap(count_iterator<T>(begin, end));
+			}
+		
+		template<typename T, typename NextFunc>
+			constexpr auto range(T begin, T end, NextFunc next_func) {
+				return range(begin, [end](const T& v) noexcept(noexcept(v == end)) { return v == end; }, next_func);
+			}
+
+		template<typename T>
+			constexpr wrapper_t<stl_iterator_t<T>> stl_iterator(T&& first, T&& last) {
+				return wrap(stl_iterator_t<T>(std::forward<T>(first), std::forward<T>(last)));
+			}
+
+		template<typename T>
+			constexpr auto stl_container(T& container) {
+				return stl_iterator(begin(container), end(container));
+			}
+	}
+}
@@ -0,0 +1,1387 @@
+#pragma once
+
+/**
+ * Files and text: mapped files, lines, CSV, JSON lines, gzip and zstd
+ * streams, directories and the binary and columnar formats.
+ */
+
+#include "core.hpp"
+#include "bits.hpp"
+#include "simd.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+#if defined(LAZYPP_WITH_ZLIB)
+#include <zlib.h>
+#endif
+
+#if defined(LAZYPP_WITH_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace lazypp {
+
+    /**
+     * Read only view of a whole file, memory mapped where available.
+     * Throws std::system_error when the file can't be opened.
+     */
+    class mapped_file {
+        public:
+            explicit mapped_file(const std::filesystem::path& path) : data_(nullptr), size_(0) {
+#if defined(__unix__) || defined(__APPLE__)
+                int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                    throw std::system_error(errno, std::generic_category(), path.string());
+                struct stat st;
+                if (::fstat(fd, &st)) {
+                    int error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), path.string());
+                }
+                size_ = static_cast<size_t>(st.st_size);
+                if (size_) {
+                    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data == MAP_FAILED) {
+                        int error = errno;
+                        ::close(fd);
+                        throw std::system_error(error, std::generic_category(), path.string());
+                    }
+                    data_ = static_cast<const char*>(data);
+                }
+                ::close(fd);
+#else
+                std::ifstream file(path, std::ios::binary);
+                if (!file)
+                    throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path.string());
+                std::ostringstream contents;
+                contents << file.rdbuf();
+                buffer_ = contents.str();
+                data_ = buffer_.data();
+                size_ = buffer_.size();
+#endif
+            }
+
+            mapped_file(const mapped_file&) = delete;
+            mapped_file& operator=(const mapped_file&) = delete;
+
+            ~mapped_file() {
+#if defined(__unix__) || defined(__APPLE__)
+                if (data_)
+                    ::munmap(const_cast<char*>(data_), size_);
+#endif
+            }
+
+            const char* data() const {
+                return data_;
+            }
+
+            size_t size() const {
+                return size_;
+            }
+
+            std::string_view view() const {
+                return std::string_view(data_, size_);
+            }
+
+        private:
+            const char* data_;
+            size_t size_;
+#if !defined(__unix__) && !defined(__APPLE__)
+            std::string buffer_;
+#endif
+    };
+
+    /**
+     * Non owning handle to a JSON value inside some text. Nothing is parsed
+     * up front: operator[] scans the members of an object until it finds the
+     * key, skipping the values of the others, and the as_* accessors only
+     * convert the token they are called on. Strings are returned raw, escape
+     * sequences are not decoded. A missing or malformed value is empty.
+     */
+    class json_value {
+        public:
+            json_value() {}
+            explicit json_value(std::string_view text) : text_(trim(text)) {}
+
+            explicit operator bool() const {
+                return !text_.empty();
+            }
+
+            std::string_view raw() const {
+                return text_;
+            }
+
+            bool is_null() const { return text_ == "null"; }
+            bool is_bool() const { return text_ == "true" || text_ == "false"; }
+            bool is_string() const { return !text_.empty() && text_.front() == '"'; }
+            bool is_object() const { return !text_.empty() && text_.front() == '{'; }
+            bool is_array() const { return !text_.empty() && text_.front() == '['; }
+            bool is_number() const { return !text_.empty() && (text_.front() == '-' || (text_.front() >= '0' && text_.front() <= '9')); }
+
+            /**
+             * Member key of an object.
+             */
+            json_value operator[](std::string_view key) const {
+                if (!is_object())
+                    return json_value();
+
+                size_t pos = skip_space(1);
+                while (pos < text_.size() && text_[pos] == '"') {
+                    size_t key_end = skip_string(pos);
+                    bool found = text_.substr(pos + 1, key_end - pos - 2) == key;
+                    pos = skip_space(key_end);
+                    if (pos >= text_.size() || text_[pos] != ':')
+                        return json_value();
+                    size_t value_begin = skip_space(pos + 1);
+                    size_t value_end = skip_value(value_begin);
+                    if (found)
+                        return json_value(text_.substr(value_begin, value_end - value_begin));
+                    pos = skip_space(value_end);
+                    if (pos >= text_.size() || text_[pos] != ',')
+                        return json_value();
+                    pos = skip_space(pos + 1);
+                }
+                return json_value();
+            }
+
+            std::string_view as_string() const {
+                return is_string() && text_.size() >= 2 ? text_.substr(1, text_.size() - 2) : std::string_view();
+            }
+
+            std::optional<bool> as_bool() const {
+                return is_bool() ? std::optional<bool>(text_ == "true") : std::optional<bool>();
+            }
+
+            std::optional<int64_t> as_int64() const {
+                return convert<int64_t>();
+            }
+
+            std::optional<double> as_double() const {
+                return convert<double>();
+            }
+
+        private:
+            template<typename T>
+                std::optional<T> convert() const {
+                    T value;
+                    auto result = std::from_chars(text_.data(), text_.data() + text_.size(), value);
+                    if (result.ec != std::errc() || result.ptr != text_.data() + text_.size())
+                        return std::optional<T>();
+                    return std::optional<T>(value);
+                }
+
+            static bool is_space(char c) {
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+            }
+
+            static std::string_view trim(std::string_view text) {
+                while (!text.empty() && is_space(text.front()))
+                    text.remove_prefix(1);
+                while (!text.empty() && is_space(text.back()))
+                    text.remove_suffix(1);
+                return text;
+            }
+
+            size_t skip_space(size_t pos) const {
+                while (pos < text_.size() && is_space(text_[pos]))
+                    pos++;
+                return pos;
+            }
+
+            /**
+             * pos is an opening quote, returns the position after the closing one.
+             */
+            size_t skip_string(size_t pos) const {
+                for (pos++; pos < text_.size(); pos++) {
+                    if (text_[pos] == '\\')
+                        pos++;
+                    else if (text_[pos] == '"')
+                        return pos + 1;
+                }
+                return text_.size();
+            }
+
+            size_t skip_value(size_t pos) const {
+                if (pos >= text_.size())
+                    return pos;
+                if (text_[pos] == '"')
+                    return skip_string(pos);
+                if (text_[pos] == '{' || text_[pos] == '[') {
+                    size_t depth = 0;
+                    while (pos < text_.size()) {
+                        char c = text_[pos];
+                        if (c == '"') {
+                            pos = skip_string(pos);
+                            continue;
+                        }
+                        if (c == '{' || c == '[')
+                            depth++;
+                        else if ((c == '}' || c == ']') && !--depth)
+                            return pos + 1;
+                        pos++;
+                    }
+                    return pos;
+                }
+                while (pos < text_.size() && text_[pos] != ',' && text_[pos] != '}' && text_[pos] != ']' && !is_space(text_[pos]))
+                    pos++;
+                return pos;
+            }
+
+            std::string_view text_;
+    };
+
+    namespace detail {
+        /**
+         * Runs a Decoder on a background thread, filling one of two blocks
+         * while the consumer reads the other one. Decoder::decode(out, capacity)
+         * returns the number of bytes written, 0 at the end of the stream.
+         * An exception thrown by the decoder is rethrown to the consumer.
+         */
+        template<typename Decoder>
+            class background_decoder {
+                public:
+                    background_decoder(Decoder decoder, size_t block_size, const std::shared_ptr<memory_budget>& budget = nullptr)
+                        : decoder_(std::move(decoder)), block_size_(block_size ? block_size : 1), current_(-1), stop_(false) {
+                        memory_.set_budget(budget);
+                        memory_.resize(2 * block_size_);
+                        for (int i = 0; i < 2; i++) {
+                            blocks_[i].reset(new char[block_size_]);
+                            sizes_[i] = 0;
+                            ready_[i] = false;
+                        }
+                        thread_ = std::thread([this]() { produce(); });
+                    }
+
+                    background_decoder(const background_decoder&) = delete;
+
+                    ~background_decoder() {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            stop_ = true;
+                        }
+                        cv_.notify_all();
+                        thread_.join();
+                    }
+
+                    /**
+                     * Releases the previous block and waits for the next one,
+                     * an empty view means the end of the stream.
+                     */
+                    std::string_view next_block() {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        if (current_ >= 0) {
+                            if (!sizes_[current_])
+                                return std::string_view();
+                            ready_[current_] = false;
+                            cv_.notify_all();
+                        }
+                        current_ = current_ < 0 ? 0 : current_ ^ 1;
+                        cv_.wait(lock, [this]() { return ready_[current_]; });
+                        if (error_)
+                            std::rethrow_exception(error_);
+                        return std::string_view(blocks_[current_].get(), sizes_[current_]);
+                    }
+
+                private:
+                    void produce() {
+                        for (int i = 0;; i ^= 1) {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            cv_.wait(lock, [this, i]() { return stop_ || !ready_[i]; });
+                            if (stop_)
+                                return;
+                            lock.unlock();
+
+                            size_t size = 0;
+                            std::exception_ptr error;
+                            try {
+                                // fill the whole block unless the stream ends
+                                size_t n;
+                                while (size < block_size_ && (n = decoder_.decode(blocks_[i].get() + size, block_size_ - size)))
+                                    size += n;
+                            }
+                            catch (...) {
+                                error = std::current_exception();
+                                size = 0;
+                            }
+
+                            lock.lock();
+                            sizes_[i] = size;
+                            ready_[i] = true;
+                            error_ = error;
+                            cv_.notify_all();
+                            if (!size)
+                                return;
+                        }
+                    }
+
+                    Decoder decoder_;
+                    size_t block_size_;
+                    memory_reservation memory_;
+                    std::unique_ptr<char[]> blocks_[2];
+                    size_t sizes_[2];
+                    bool ready_[2];
+                    int current_;
+                    bool stop_;
+                    std::exception_ptr error_;
+                    std::mutex mutex_;
+                    std::condition_variable cv_;
+                    std::thread thread_;
+            };
+
+#if defined(LAZYPP_WITH_ZLIB)
+        /**
+         * gzip or zlib stream, concatenated gzip members are decoded one
+         * after the other. zlib counts in uInt, inputs past 4 GiB are fed
+         * to it in pieces.
+         */
+        class gzip_decoder {
+            public:
+                gzip_decoder(std::string_view input, std::shared_ptr<const mapped_file> file = nullptr)
+                    : input_(input), file_(file), stream_(new z_stream()), fed_(0), ended_(false) {
+                    if (inflateInit2(stream_.get(), 15 + 32) != Z_OK)
+                        throw std::runtime_error("lazypp: inflateInit2 failed");
+                }
+
+                gzip_decoder(gzip_decoder&& g) = default;
+
+                ~gzip_decoder() {
+                    if (stream_)
+                        inflateEnd(stream_.get());
+                }
+
+                size_t decode(char* out, size_t capacity) {
+                    capacity = std::min(capacity, size_t(std::numeric_limits<uInt>::max()));
+                    while (!ended_) {
+                        if (!stream_->avail_in && fed_ < input_.size()) {
+                            size_t piece = std::min(input_.size() - fed_, size_t(std::numeric_limits<uInt>::max()));
+                            stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input_.data() + fed_));
+                            stream_->avail_in = static_cast<uInt>(piece);
+                            fed_ += piece;
+                        }
+                        stream_->next_out = reinterpret_cast<Bytef*>(out);
+                        stream_->avail_out = static_cast<uInt>(capacity);
+                        int result = inflate(stream_.get(), Z_NO_FLUSH);
+                        size_t written = capacity - stream_->avail_out;
+                        bool more_input = stream_->avail_in || fed_ < input_.size();
+                        if (result == Z_STREAM_END) {
+                            if (more_input)
+                                inflateReset(stream_.get());
+                            else
+                                ended_ = true;
+                        }
+                        else if (result != Z_OK && result != Z_BUF_ERROR) {
+                            throw std::runtime_error(std::string("lazypp: gzip stream error ") + (stream_->msg ? stream_->msg : ""));
+                        }
+                        else if (!written && !more_input) {
+                            throw std::runtime_error("lazypp: truncated gzip stream");
+                        }
+                        if (written)
+                            return written;
+                    }
+                    return 0;
+                }
+
+            private:
+                std::string_view input_;
+                std::shared_ptr<const mapped_file> file_;
+                std::unique_ptr<z_stream> stream_;
+                size_t fed_;
+                bool ended_;
+        };
+#endif
+
+#if defined(LAZYPP_WITH_ZSTD)
+        class zstd_decoder {
+            public:
+                zstd_decoder(std::string_view input, std::shared_ptr<const mapped_file> file = nullptr)
+                    : file_(file), stream_(ZSTD_createDStream(), ZSTD_freeDStream), input_{input.data(), input.size(), 0}, pending_(false) {
+                    if (!stream_)
+                        throw std::runtime_error("lazypp: ZSTD_createDStream failed");
+                }
+
+                size_t decode(char* out, size_t capacity) {
+                    ZSTD_outBuffer output{out, capacity, 0};
+                    while (input_.pos < input_.size || pending_) {
+                        size_t before = input_.pos;
+                        size_t result = ZSTD_decompressStream(stream_.get(), &output, &input_);
+                        if (ZSTD_isError(result))
+                            throw std::runtime_error(std::string("lazypp: zstd stream error ") + ZSTD_getErrorName(result));
+                        // nonzero until a frame is decoded and flushed, output may still be buffered in zstd
+                        pending_ = result != 0;
+                        if (output.pos)
+                            return output.pos;
+                        if (input_.pos == before && input_.pos == input_.size) {
+                            if (pending_)
+                                throw std::runtime_error("lazypp: truncated zstd stream");
+                            break;
+                        }
+                    }
+                    return 0;
+                }
+
+            private:
+                std::shared_ptr<const mapped_file> file_;
+                std::unique_ptr<ZSTD_DStream, size_t (*)(ZSTD_DStream*)> stream_;
+                ZSTD_inBuffer input_;
+                bool pending_;
+        };
+#endif
+    }
+
+    namespace detail {
+        /**
+         * 16 byte header of the write_binary format, followed by the encoded
+         * elements.
+         */
+        struct binary_header {
+            char magic[4];
+            uint8_t version;
+            binary_encoding encoding;
+            uint16_t reserved;
+            uint32_t element_size;
+            uint32_t reserved2;
+        };
+
+        static_assert(sizeof(binary_header) == 16, "unexpected binary_header padding");
+
+        inline constexpr char binary_magic[4] = {'L', 'Z', 'P', 'B'};
+
+        /**
+         * Buffered output file, throws std::system_error on I/O errors.
+         */
+        class file_writer {
+            public:
+                file_writer(const std::filesystem::path& path)
+                    : path_(path), file_(std::fopen(path.c_str(), "wb")), buffer_(new uint8_t[buffer_size]), used_(0) {
+                    if (!file_)
+                        throw std::system_error(errno, std::generic_category(), path_.string());
+                }
+
+                file_writer(const file_writer&) = delete;
+
+                ~file_writer() {
+                    if (file_)
+                        std::fclose(file_);
+                }
+
+                void write(const void* data, size_t size) {
+                    if (used_ + size > buffer_size)
+                        flush();
+                    if (size > buffer_size) {
+                        if (std::fwrite(data, 1, size, file_) != size)
+                            throw std::system_error(errno, std::generic_category(), path_.string());
+                        return;
+                    }
+                    std::memcpy(buffer_.get() + used_, data, size);
+                    used_ += size;
+                }
+
+                void write_varint(uint64_t v) {
+                    if (used_ + 10 > buffer_size)
+                        flush();
+                    used_ += put_varint(v, buffer_.get() + used_);
+                }
+
+                void close() {
+                    flush();
+                    int result = std::fclose(file_);
+                    file_ = nullptr;
+                    if (result)
+                        throw std::system_error(errno, std::generic_category(), path_.string());
+                }
+
+            private:
+                static constexpr size_t buffer_size = 1 << 16;
+
+                void flush() {
+                    if (used_ && std::fwrite(buffer_.get(), 1, used_, file_) != used_)
+                        throw std::system_error(errno, std::generic_category(), path_.string());
+                    used_ = 0;
+                }
+
+                std::filesystem::path path_;
+                std::FILE* file_;
+                std::unique_ptr<uint8_t[]> buffer_;
+                size_t used_;
+        };
+
+        template<typename T>
+            class binary_writer {
+                public:
+                    binary_writer(const std::filesystem::path& path, binary_encoding encoding)
+                        : file_(path), encoding_(encoding), previous_(0) {
+                        binary_header header = {{}, 1, encoding, 0, uint32_t(sizeof(T)), 0};
+                        std::copy(binary_magic, binary_magic + 4, header.magic);
+                        file_.write(&header, sizeof(header));
+                    }
+
+                    void push(const T& v) {
+                        if (encoding_ == binary_encoding::raw) {
+                            file_.write(&v, sizeof(T));
+                            return;
+                        }
+                        push_varint(v, std::is_integral<T>());
+                    }
+
+                    void close() {
+                        file_.close();
+                    }
+
+                private:
+                    void push_varint(const T& v, std::true_type) {
+                        if (encoding_ == binary_encoding::delta_varint)
+                            file_.write_varint(to_delta_varint_value(v, T(previous_)));
+                        else
+                            file_.write_varint(to_varint_value(v));
+                        previous_ = v;
+                    }
+
+                    void push_varint(const T&, std::false_type) {
+                    }
+
+                    file_writer file_;
+                    binary_encoding encoding_;
+                    std::conditional_t<std::is_integral<T>::value, T, int> previous_;
+            };
+
+        /**
+         * Header of the write_columnar format. Each block that follows starts
+         * with a columnar_block_header<T> and then holds count raw values.
+         * NaN counts as the largest value in the min and max of a block.
+         */
+        struct columnar_header {
+            char magic[4];
+            uint8_t version;
+            uint8_t reserved[3];
+            uint32_t element_size;
+            uint32_t block_size;
+        };
+
+        static_assert(sizeof(columnar_header) == 16, "unexpected columnar_header padding");
+
+        inline constexpr char columnar_magic[4] = {'L', 'Z', 'P', 'C'};
+
+        template<typename T>
+            struct columnar_block_header {
+                uint64_t count;
+                T min;
+                T max;
+            };
+
+        /**
+         * Accumulates block_size values and writes them with their zone map.
+         */
+        template<typename T>
+            class columnar_writer {
+                public:
+                    columnar_writer(const std::filesystem::path& path, size_t block_size)
+                        : file_(path), block_size_(block_size ? block_size : 1) {
+                        columnar_header header = {{}, 1, {}, uint32_t(sizeof(T)), uint32_t(block_size_)};
+                        std::copy(columnar_magic, columnar_magic + 4, header.magic);
+                        file_.write(&header, sizeof(header));
+                        block_.reserve(block_size_);
+                    }
+
+                    void push(const T& v) {
+                        block_.push_back(v);
+                        if (block_.size() == block_size_)
+                            flush_block();
+                    }
+
+                    void close() {
+                        flush_block();
+                        file_.close();
+                    }
+
+                private:
+                    void flush_block() {
+                        if (block_.empty())
+                            return;
+                        // NaN sorts after everything, so a block holding one has a NaN max
+                        auto min_max = std::minmax_element(block_.begin(), block_.end(),
+                                [](const T& a, const T& b) { return a < b || (a == a && b != b); });
+                        // zeroed first so the padding after small T isn't written uninitialized
+                        columnar_block_header<T> header;
+                        std::memset(&header, 0, sizeof(header));
+                        header.count = block_.size();
+                        header.min = *min_max.first;
+                        header.max = *min_max.second;
+                        file_.write(&header, sizeof(header));
+                        file_.write(block_.data(), block_.size() * sizeof(T));
+                        block_.clear();
+                    }
+
+                    file_writer file_;
+                    size_t block_size_;
+                    std::vector<T> block_;
+            };
+    }
+
+    /**
+     * Predicates usable both on elements and on the [min, max] zone map of a
+     * block of them, so that sources storing such statistics can skip blocks
+     * that can't match (see from::columnar). They also work as plain filter
+     * functions.
+     */
+    namespace where {
+        struct any {
+            template<typename T>
+                bool operator()(const T&) const { return true; }
+            template<typename T>
+                bool may_match(const T&, const T&) const { return true; }
+            template<typename T>
+                bool all_match(const T&, const T&) const { return true; }
+        };
+
+        /**
+         * lo <= v <= hi
+         */
+        template<typename V>
+            struct between {
+                between(V lo, V hi) : lo_(lo), hi_(hi) {}
+
+                template<typename T>
+                    bool operator()(const T& v) const { return !(v < lo_) && !(hi_ < v); }
+                template<typename T>
+                    bool may_match(const T& min, const T& max) const { return !(max < lo_) && !(hi_ < min); }
+                template<typename T>
+                    bool all_match(const T& min, const T& max) const { return !(min < lo_) && !(hi_ < max); }
+
+                V lo_;
+                V hi_;
+            };
+
+        template<typename V>
+            struct less {
+                less(V v) : v_(v) {}
+
+                template<typename T>
+                    bool operator()(const T& v) const { return v < v_; }
+                template<typename T>
+                    bool may_match(const T& min, const T&) const { return min < v_; }
+                template<typename T>
+                    bool all_match(const T&, const T& max) const { return max < v_; }
+
+                V v_;
+            };
+
+        template<typename V>
+            struct greater {
+                greater(V v) : v_(v) {}
+
+                template<typename T>
+                    bool operator()(const T& v) const { return v_ < v; }
+                template<typename T>
+                    bool may_match(const T&, const T& max) const { return v_ < max; }
+                template<typename T>
+                    bool all_match(const T& min, const T&) const { return v_ < min; }
+
+                V v_;
+            };
+
+        template<typename V>
+            struct equal {
+                equal(V v) : v_(v) {}
+
+                template<typename T>
+                    bool operator()(const T& v) const { return v == v_; }
+                template<typename T>
+                    bool may_match(const T& min, const T& max) const { return !(v_ < min) && !(max < v_); }
+                template<typename T>
+                    bool all_match(const T& min, const T& max) const { return min == v_ && max == v_; }
+
+                V v_;
+            };
+
+        template<typename A, typename B>
+            struct both {
+                both(A a, B b) : a_(a), b_(b) {}
+
+                template<typename T>
+                    bool operator()(const T& v) const { return a_(v) && b_(v); }
+                template<typename T>
+                    bool may_match(const T& min, const T& max) const { return a_.may_match(min, max) && b_.may_match(min, max); }
+                template<typename T>
+                    bool all_match(const T& min, const T& max) const { return a_.all_match(min, max) && b_.all_match(min, max); }
+
+                A a_;
+                B b_;
+            };
+
+        /**
+         * Whether P is one of the zone map predicates above. They take any
+         * element type, so unlike is_predicate this needs none.
+         */
+        template<typename P>
+            struct is_zone_predicate : std::false_type {};
+
+        template<>
+            struct is_zone_predicate<any> : std::true_type {};
+
+        template<typename V>
+            struct is_zone_predicate<between<V>> : std::true_type {};
+
+        template<typename V>
+            struct is_zone_predicate<less<V>> : std::true_type {};
+
+        template<typename V>
+            struct is_zone_predicate<greater<V>> : std::true_type {};
+
+        template<typename V>
+            struct is_zone_predicate<equal<V>> : std::true_type {};
+
+        template<typename A, typename B>
+            struct is_zone_predicate<both<A, B>> : std::true_type {};
+
+        /**
+         * Only zone map predicates combine, other where:: types found by
+         * ADL keep the built-in &&.
+         */
+        template<typename A, typename B, typename = std::enable_if_t<is_zone_predicate<A>::value && is_zone_predicate<B>::value>>
+            both<A, B> operator&&(A a, B b) {
+                return both<A, B>(a, b);
+            }
+
+        /**
+         * Whether P can be evaluated on a zone map of T values.
+         */
+        template<typename P, typename T, typename = void>
+            struct is_predicate : std::false_type {};
+
+        template<typename P, typename T>
+            struct is_predicate<P, T, std::void_t<decltype(std::declval<const P&>().may_match(std::declval<const T&>(), std::declval<const T&>())),
+                decltype(std::declval<const P&>().all_match(std::declval<const T&>(), std::declval<const T&>()))>>
+                : std::true_type {};
+    }
+
+    namespace iterators {
+        /**
+         * Lazily yields the entries of a directory, descending into
+         * subdirectories (not symlinks to them) when recursive. A directory
+         * that can't be opened or read is skipped, the walk goes on with
+         * its siblings: each level has its own std::filesystem iterator,
+         * recursive_directory_iterator ending the whole walk on any error.
+         */
+        class directory_iterator {
+            public:
+                typedef std::filesystem::directory_entry value_type;
+
+                directory_iterator() = delete;
+                directory_iterator(const std::filesystem::path& path, bool recursive) : recursive_(recursive) {
+                    stack_.emplace_back(path, std::filesystem::directory_options::skip_permission_denied);
+                }
+
+                std::optional<value_type> next() {
+                    while (!stack_.empty()) {
+                        if (stack_.back() == std::filesystem::directory_iterator()) {
+                            stack_.pop_back();
+                            continue;
+                        }
+
+                        value_type entry = *stack_.back();
+                        std::error_code ec;
+                        stack_.back().increment(ec);
+                        if (ec)
+                            stack_.back() = std::filesystem::directory_iterator();
+                        if (recursive_ && entry.symlink_status(ec).type() == std::filesystem::file_type::directory) {
+                            std::filesystem::directory_iterator child(entry.path(), std::filesystem::directory_options::skip_permission_denied, ec);
+                            if (!ec)
+                                stack_.push_back(std::move(child));
+                        }
+                        return std::optional<value_type>(std::move(entry));
+                    }
+                    return std::optional<value_type>();
+                }
+
+            private:
+                std::vector<std::filesystem::directory_iterator> stack_;
+                bool recursive_;
+        };
+
+        /**
+         * Yields the lines of text as views into it, without the line
+         * terminator (\n or \r\n).
+         */
+        class line_iterator {
+            public:
+                typedef std::string_view value_type;
+
+                line_iterator() = delete;
+                line_iterator(std::string_view text) : text_(text), pos_(0) {}
+
+                std::optional<value_type> next() {
+                    if (pos_ >= text_.size())
+                        return std::optional<value_type>();
+
+                    const char* begin = text_.data() + pos_;
+                    const char* end = static_cast<const char*>(std::memchr(begin, '\n', text_.size() - pos_));
+                    size_t length = end ? size_t(end - begin) : text_.size() - pos_;
+                    pos_ += length + 1;
+                    if (length && begin[length - 1] == '\r')
+                        length--;
+                    return std::optional<value_type>(value_type(begin, length));
+                }
+
+            private:
+                std::string_view text_;
+                size_t pos_;
+        };
+
+        /**
+         * Yields the lines of a sequence of string_view chunks (e.g. blocks
+         * from a decompressing source). Lines are views into the current chunk
+         * when they fit in it, lines crossing chunks are assembled in an
+         * internal buffer. A line is valid until the next call to next().
+         */
+        template<typename BaseIterator> IF_HAS_CONCEPTS(requires LazyIterator<BaseIterator>)
+            class chunk_line_iterator {
+                public:
+                    typedef std::string_view value_type;
+
+                    chunk_line_iterator() = delete;
+                    chunk_line_iterator(BaseIterator base) : base_(base), returned_carry_(false), ended_(false) {}
+
+                    void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                        memory_.set_budget(budget);
+                    }
+
+                    std::optional<value_type> next() {
+                        if (returned_carry_) {
+                            carry_.clear();
+                            returned_carry_ = false;
+                        }
+
+                        while (true) {
+                            size_t end = chunk_.find('\n');
+                            if (end != std::string_view::npos) {
+                                std::string_view line = chunk_.substr(0, end);
+                                chunk_.remove_prefix(end + 1);
+                                if (!carry_.empty()) {
+                                    append(line);
+                                    line = carry_;
+                                    returned_carry_ = true;
+                                }
+                                return std::optional<value_type>(strip(line));
+                            }
+
+                            append(chunk_);
+                            chunk_ = std::string_view();
+                            if (ended_)
+                                break;
+                            // an empty chunk is just a short read, only nullopt ends the input
+                            auto chunk = base_.next();
+                            if (chunk)
+                                chunk_ = *chunk;
+                            else
+                                ended_ = true;
+                        }
+
+                        if (carry_.empty())
+                            return std::optional<value_type>();
+                        returned_carry_ = true;
+                        return std::optional<value_type>(strip(carry_));
+                    }
+
+                private:
+                    void append(std::string_view piece) {
+                        if (carry_.size() + piece.size() > carry_.capacity())
+                            memory_.resize(carry_.size() + piece.size());
+                        carry_.append(piece.data(), piece.size());
+                        memory_.resize(carry_.capacity());
+                    }
+
+                    static std::string_view strip(std::string_view line) {
+                        if (!line.empty() && line.back() == '\r')
+                            line.remove_suffix(1);
+                        return line;
+                    }
+
+                    BaseIterator base_;
+                    std::string_view chunk_;
+                    std::string carry_;
+                    detail::memory_reservation memory_;
+                    bool returned_carry_;
+                    bool ended_;
+            };
+
+        /**
+         * Yields the blocks produced by a background_decoder, a block is valid
+         * until the next call to next(). Decoding starts on the first call,
+         * copies share the decoder.
+         */
+        template<typename Decoder>
+            class decompress_iterator {
+                public:
+                    typedef std::string_view value_type;
+
+                    decompress_iterator() = delete;
+                    decompress_iterator(std::function<Decoder()> make_decoder, size_t block_size)
+                        : make_decoder_(make_decoder), block_size_(block_size) {}
+
+                    /**
+                     * The two blocks are accounted when decoding starts.
+                     */
+                    void set_budget(const std::shared_ptr<memory_budget>& budget) {
+                        budget_ = budget;
+                    }
+
+                    std::optional<value_type> next() {
+                        if (!decoder_)
+                            decoder_ = std::make_shared<detail::background_decoder<Decoder>>(make_decoder_(), block_size_, budget_);
+                        std::string_view block = decoder_->next_block();
+                        if (block.empty())
+                            return std::optional<value_type>();
+                        return std::optional<value_type>(block);
+                    }
+
+                private:
+                    std::function<Decoder()> make_decoder_;
+                    size_t block_size_;
+                    std::shared_ptr<memory_budget> budget_;
+                    std::shared_ptr<detail::background_decoder<Decoder>> decoder_;
+            };
+
+        /**
+         * Reads back a file written by write_binary. Raw elements are loaded
+         * straight from the mapping, varints are decoded as they are read.
+         */
+        template<typename T>
+            class binary_iterator {
+                public:
+                    typedef T value_type;
+
+                    binary_iterator() = delete;
+                    binary_iterator(std::shared_ptr<const mapped_file> file) : file_(file), previous_(0) {
+                        detail::binary_header header;
+                        if (file_->size() < sizeof(header))
+                            throw std::runtime_error("lazypp: binary file too short");
+                        std::memcpy(&header, file_->data(), sizeof(header));
+                        if (!std::equal(header.magic, header.magic + 4, detail::binary_magic) || header.version != 1)
+                            throw std::runtime_error("lazypp: not a lazypp binary file");
+                        if (header.element_size != sizeof(T))
+                            throw std::runtime_error("lazypp: binary file element size mismatch");
+                        if (header.encoding != binary_encoding::raw && !std::is_integral<T>::value)
+                            throw std::runtime_error("lazypp: varint encoded binary file read as a non integer type");
+                        encoding_ = header.encoding;
+                        actual_ = reinterpret_cast<const uint8_t*>(file_->data()) + sizeof(header);
+                        last_ = reinterpret_cast<const uint8_t*>(file_->data()) + file_->size();
+                    }
+
+                    std::optional<value_type> next() {
+                        if (encoding_ == binary_encoding::raw) {
+                            if (size_t(last_ - actual_) < sizeof(T))
+                                return std::optional<value_type>();
+                            T v;
+                            std::memcpy(&v, actual_, sizeof(T));
+                            actual_ += sizeof(T);
+                            return std::optional<value_type>(v);
+                        }
+                        return next_varint(std::is_integral<T>());
+                    }
+
+                    /**
+                     * Number of elements left. For varint files it counts the
+                     * bytes that end a varint (high bit clear), one pass over
+                     * the rest of the mapping.
+                     */
+                    size_t size() const {
+                        if (encoding_ == binary_encoding::raw)
+                            return size_t(last_ - actual_) / sizeof(T);
+                        return size_t(std::count_if(actual_, last_, [](uint8_t byte) { return !(byte & 0x80); }));
+                    }
+
+                private:
+                    std::optional<value_type> next_varint(std::true_type) {
+                        uint64_t encoded;
+                        if (actual_ >= last_)
+                            return std::optional<value_type>();
+                        if (!detail::get_varint(actual_, last_, encoded))
+                            throw std::runtime_error("lazypp: truncated varint in binary file");
+                        if (encoding_ == binary_encoding::delta_varint)
+                            return std::optional<value_type>(previous_ = detail::from_delta_varint_value(encoded, T(previous_)));
+                        return std::optional<value_type>(detail::from_varint_value<T>(encoded));
+                    }
+
+                    std::optional<value_type> next_varint(std::false_type) {
+                        return std::optional<value_type>();
+                    }
+
+                    std::shared_ptr<const mapped_file> file_;
+                    binary_encoding encoding_;
+                    const uint8_t* actual_;
+                    const uint8_t* last_;
+                    std::conditional_t<std::is_integral<T>::value, T, int> previous_;
+            };
+
+        /**
+         * Reads back a file written by write_columnar, yielding the elements
+         * matching Predicate (a where:: predicate). Blocks whose zone map
+         * can't match are skipped without reading their values, elements of
+         * blocks that fully match are not tested one by one.
+         */
+        template<typename T, typename Predicate>
+            class columnar_iterator {
+                public:
+                    typedef T value_type;
+
+                    columnar_iterator() = delete;
+                    columnar_iterator(std::shared_ptr<const mapped_file> file, Predicate predicate)
+                        : file_(file), predicate_(predicate), remaining_(0), check_(false) {
+                        detail::columnar_header header;
+                        if (file_->size() < sizeof(header))
+                            throw std::runtime_error("lazypp: columnar file too short");
+                        std::memcpy(&header, file_->data(), sizeof(header));
+                        if (!std::equal(header.magic, header.magic + 4, detail::columnar_magic) || header.version != 1)
+                            throw std::runtime_error("lazypp: not a lazypp columnar file");
+                        if (header.element_size != sizeof(T))
+                            throw std::runtime_error("lazypp: columnar file element size mismatch");
+                        actual_ = reinterpret_cast<const uint8_t*>(file_->data()) + sizeof(header);
+                        last_ = reinterpret_cast<const uint8_t*>(file_->data()) + file_->size();
+                    }
+
+                    std::optional<value_type> next() {
+                        while (true) {
+                            while (!remaining_) {
+                                if (!next_block())
+                                    return std::optional<value_type>();
+                            }
+
+                            T v;
+                            std::memcpy(&v, actual_, sizeof(T));
+                            actual_ += sizeof(T);
+                            remaining_--;
+                            if (!check_ || predicate_(v))
+                                return std::optional<value_type>(v);
+                        }
+                    }
+
+                    /**
+                     * Same source restricted to the elements also matching p.
+                     */
+                    template<typename P, typename = std::enable_if_t<where::is_predicate<P, T>::value>>
+                        auto push_down(P p) const {
+                            return columnar_iterator<T, where::both<Predicate, P>>(file_, where::both<Predicate, P>(predicate_, p), actual_, last_, remaining_);
+                        }
+
+                private:
+                    template<typename, typename>
+                        friend class columnar_iterator;
+
+                    columnar_iterator(std::shared_ptr<const mapped_file> file, Predicate predicate, const uint8_t* actual, const uint8_t* last, size_t remaining)
+                        : file_(file), predicate_(predicate), actual_(actual), last_(last), remaining_(remaining), check_(remaining) {}
+
+                    bool next_block() {
+                        detail::columnar_block_header<T> header;
+                        while (size_t(last_ - actual_) >= sizeof(header)) {
+                            std::memcpy(&header, actual_, sizeof(header));
+                            actual_ += sizeof(header);
+                            size_t count = std::min<size_t>(header.count, size_t(last_ - actual_) / sizeof(T));
+                            // a NaN max means the block holds NaN the zone map can't
+                            // account for: it is read and checked element by element
+                            bool has_nan = header.max != header.max;
+                            if (has_nan || predicate_.may_match(header.min, header.max)) {
+                                remaining_ = count;
+                                check_ = has_nan || !predicate_.all_match(header.min, header.max);
+                                return true;
+                            }
+                            actual_ += count * sizeof(T);
+                        }
+                        actual_ = last_;
+                        return false;
+                    }
+
+                    std::shared_ptr<const mapped_file> file_;
+                    Predicate predicate_;
+                    const uint8_t* actual_;
+                    const uint8_t* last_;
+                    size_t remaining_;
+                    bool check_;
+            };
+
+        /**
+         * Splits CSV text into rows of N fields. Structural characters are
+         * found 64 bytes at a time: quote, delimiter and newline bitmasks are
+         * built with SIMD compares, the quoted regions come from a prefix xor
+         * of the quote mask and the remaining delimiters and newlines are
+         * walked with ctz.
+         *
+         * columns[k] is the input column stored in field k of the row, missing
+         * fields are empty and the rest of a row is skipped once the last
+         * requested column is read. Enclosing quotes and a trailing \r are
+         * removed, doubled quotes inside a field are left as they are. The
+         * fields point into text.
+         */
+        template<size_t N>
+            class csv_iterator {
+                public:
+                    typedef std::array<std::string_view, N> value_type;
+
+                    csv_iterator() = delete;
+                    csv_iterator(std::string_view text, std::array<size_t, N> columns, char delimiter, char quote)
+                        : text_(text), columns_(columns), last_column_(N ? *std::max_element(columns.begin(), columns.end()) : 0),
+                          delimiter_(delimiter), quote_(quote), block_(0), next_block_(0), structural_(0), newlines_(0),
+                          in_quotes_(0), field_start_(0), skip_row_(false), match_(detail::match3_kernel()) {}
+
+                    std::optional<value_type> next() {
+                        value_type row{};
+                        size_t column = 0;
+                        while (true) {
+                            while (!structural_) {
+                                if (next_block_ >= text_.size()) {
+                                    // a row is pending if it has a field, even an empty
+                                    // last one after a delimiter
+                                    if (field_start_ >= text_.size() && !column)
+                                        return std::optional<value_type>();
+                                    store(row, column, field_start_, text_.size());
+                                    field_start_ = text_.size();
+                                    return std::optional<value_type>(row);
+                                }
+                                load_block();
+                            }
+
+                            size_t pos = block_ + detail::count_trailing_zeros(structural_);
+                            structural_ &= structural_ - 1;
+
+                            bool end_of_row = text_[pos] == '\n';
+                            if (end_of_row && !column && pos == field_start_) {
+                                field_start_ = pos + 1;
+                                continue;
+                            }
+                            if (!skip_row_)
+                                store(row, column, field_start_, pos);
+                            column++;
+                            field_start_ = pos + 1;
+                            if (end_of_row) {
+                                skip_row_ = false;
+                                return std::optional<value_type>(row);
+                            }
+                            if (column > last_column_) {
+                                skip_row_ = true;
+                                structural_ &= newlines_;
+                            }
+                        }
+                    }
+
+                private:
+                    void load_block() {
+                        const char* p = text_.data() + next_block_;
+                        char padded[64];
+                        if (text_.size() - next_block_ < 64) {
+                            std::fill(std::copy(p, text_.data() + text_.size(), padded), padded + 64, '\0');
+                            p = padded;
+                        }
+
+                        const char needles[3] = {quote_, '\n', delimiter_};
+                        uint64_t masks[3];
+                        match_(p, needles, masks);
+                        uint64_t inside = detail::prefix_xor(masks[0]) ^ in_quotes_;
+                        in_quotes_ = uint64_t(0) - (inside >> 63);
+                        newlines_ = masks[1] & ~inside;
+                        structural_ = skip_row_ ? newlines_ : (masks[2] & ~inside) | newlines_;
+                        block_ = next_block_;
+                        next_block_ += 64;
+                    }
+
+                    void store(value_type& row, size_t column, size_t begin, size_t end) const {
+                        std::string_view field = text_.substr(begin, end - begin);
+                        if (!field.empty() && field.back() == '\r')
+                            field.remove_suffix(1);
+                        if (field.size() >= 2 && field.front() == quote_ && field.back() == quote_)
+                            field = field.substr(1, field.size() - 2);
+                        for (size_t k = 0; k < N; k++)
+                            if (columns_[k] == column)
+                                row[k] = field;
+                    }
+
+                    std::string_view text_;
+                    std::array<size_t, N> columns_;
+                    size_t last_column_;
+                    char delimiter_;
+                    char quote_;
+                    size_t block_;
+                    size_t next_block_;
+                    uint64_t structural_;
+                    uint64_t newlines_;
+                    uint64_t in_quotes_;
+                    size_t field_start_;
+                    bool skip_row_;
+                    detail::match3_func match_;
+            };
+    }
+
+	namespace from {
+
+		using namespace lazypp::iterators;
+
+		inline auto directory(const std::filesystem::path& path, bool recursive = false) {
+			return wrap(directory_iterator(path, recursive));
+		}
+
+		/**
+		 * Rows of the selected columns of CSV (or TSV with delimiter '\t')
+		 * text as arrays of string_views into text.
+		 */
+		template<size_t N>
+			auto csv_columns(std::string_view text, std::array<size_t, N> columns, char delimiter = ',', char quote = '"') {
+				return wrap(csv_iterator<N>(text, columns, delimiter, quote));
+			}
+
+		/**
+		 * Rows of the first N columns.
+		 */
+		template<size_t N>
+			auto csv(std::string_view text, char delimiter = ',', char quote = '"') {
+				std::array<size_t, N> columns;
+				for (size_t k = 0; k < N; k++)
+					columns[k] = k;
+				return csv_columns<N>(text, columns, delimiter, quote);
+			}
+
+		/**
+		 * One row per line of a sequence of string_views (e.g. from::lines
+		 * over a decompressing source). Quoted fields can't span lines here.
+		 */
+		template<size_t N, typename Iterator>
+			auto csv(wrapper<Iterator> lines, char delimiter = ',', char quote = '"') {
+				std::array<size_t, N> columns;
+				for (size_t k = 0; k < N; k++)
+					columns[k] = k;
+				return lines.map([columns, delimiter, quote](std::string_view line) {
+						return csv_iterator<N>(line, columns, delimiter, quote).next().value_or(std::array<std::string_view, N>());
+					});
+			}
+
+		template<size_t N>
+			auto csv(const mapped_file& file, char delimiter = ',', char quote = '"') {
+				return csv<N>(file.view(), delimiter, quote);
+			}
+
+		template<size_t N>
+			auto csv_columns(const mapped_file& file, std::array<size_t, N> columns, char delimiter = ',', char quote = '"') {
+				return csv_columns<N>(file.view(), columns, delimiter, quote);
+			}
+
+		inline auto lines(std::string_view text) {
+			return wrap(line_iterator(text));
+		}
+
+		inline auto lines(const mapped_file& file) {
+			return lines(file.view());
+		}
+
+		/**
+		 * Lines of a sequence of string_view chunks such as from::gzip, each
+		 * line is valid until the next one is read.
+		 */
+		template<typename Iterator>
+			auto lines(wrapper<Iterator> chunks) {
+				return chunks.rewrap(chunk_line_iterator<Iterator>(chunks.iterator()));
+			}
+
+#if defined(LAZYPP_WITH_ZLIB)
+		/**
+		 * Decompressed blocks of block_size bytes (the last one may be
+		 * shorter) of gzip data, decoded on a background thread while the
+		 * previous block is consumed. compressed must outlive the pipeline.
+		 */
+		inline auto gzip(std::string_view compressed, size_t block_size = 1 << 20) {
+			return wrap(decompress_iterator<detail::gzip_decoder>(
+					[compressed]() { return detail::gzip_decoder(compressed); }, block_size));
+		}
+
+		inline auto gzip(const mapped_file& file, size_t block_size = 1 << 20) {
+			return gzip(file.view(), block_size);
+		}
+
+		/**
+		 * Maps the file at path, which stays mapped while the pipeline exists.
+		 */
+		inline auto gzip_file(const std::filesystem::path& path, size_t block_size = 1 << 20) {
+			auto file = std::make_shared<const mapped_file>(path);
+			return wrap(decompress_iterator<detail::gzip_decoder>(
+					[file]() { return detail::gzip_decoder(file->view(), file); }, block_size));
+		}
+#endif
+
+#if defined(LAZYPP_WITH_ZSTD)
+		inline auto zstd(std::string_view compressed, size_t block_size = 1 << 20) {
+			return wrap(decompress_iterator<detail::zstd_decoder>(
+					[compressed]() { return detail::zstd_decoder(compressed); }, block_size));
+		}
+
+		inline auto zstd(const mapped_file& file, size_t block_size = 1 << 20) {
+			return zstd(file.view(), block_size);
+		}
+
+		/**
+		 * Maps the file at path, which stays mapped while the pipeline exists.
+		 */
+		inline auto zstd_file(const std::filesystem::path& path, size_t block_size = 1 << 20) {
+			auto file = std::make_shared<const mapped_file>(path);
+			return wrap(decompress_iterator<detail::zstd_decoder>(
+					[file]() { return detail::zstd_decoder(file->view(), file); }, block_size));
+		}
+#endif
+
+		/**
+		 * One json_value per non blank line of a sequence of string_views
+		 * (e.g. from::lines), fields are only located when accessed.
+		 */
+		template<typename Iterator>
+			auto json_lines(wrapper<Iterator> lines) {
+				return lines
+					.filter([](std::string_view line) { return line.find_first_not_of(" \t\r") != std::string_view::npos; })
+					.map([](std::string_view line) { return json_value(line); });
+			}
+
+		inline auto json_lines(std::string_view text) {
+			return json_lines(lines(text));
+		}
+
+		inline auto json_lines(const mapped_file& file) {
+			return json_lines(file.view());
+		}
+
+		/**
+		 * Elements of a file written by write_binary, the file stays mapped
+		 * while the pipeline exists.
+		 */
+		template<typename T>
+			auto binary(const std::filesystem::path& path) {
+				static_assert(std::is_trivially_copyable<T>::value, "binary needs trivially copyable elements");
+				return wrap(binary_iterator<T>(std::make_shared<const mapped_file>(path)));
+			}
+
+		/**
+		 * Elements of a file written by write_columnar matching predicate
+		 * (see lazypp::where), skipping the blocks whose min and max show they
+		 * can't match. A where:: predicate passed to filter() afterwards is
+		 * pushed down the same way.
+		 */
+		template<typename T, typename Predicate = where::any>
+			auto columnar(const std::filesystem::path& path, Predicate predicate = Predicate()) {
+				return wrap(columnar_iterator<T, Predicate>(std::make_shared<const mapped_file>(path), predicate));
+			}
+	}
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+/**
+ * Sources running on a pool of threads: from::parallel_directory.
+ */
+
+#include "core.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace lazypp {
+
+    /**
+     * Order in which from::parallel_directory yields entries: unordered as
+     * soon as a directory is listed, sorted in the same pre-order as a
+     * sequential walk with the entries of each directory sorted by name.
+     */
+    enum class walk_order {
+        unordered,
+        sorted
+    };
+
+    struct walk_entry {
+        std::filesystem::path path;
+        std::filesystem::file_type type;
+
+        bool is_directory() const {
+            return type == std::filesystem::file_type::directory;
+        }
+
+        bool is_regular_file() const {
+            return type == std::filesystem::file_type::regular;
+        }
+    };
+
+    namespace detail {
+        struct walk_node {
+            std::filesystem::path path;
+            std::vector<walk_entry> entries;
+            // parallel to entries, null for anything but directories (and
+            // once the consumer descended into them, sorted walks only)
+            std::vector<std::shared_ptr<walk_node>> children;
+            bool ready = false;
+        };
+
+        /**
+         * Lists directories on a pool of threads. Every listed directory
+         * queues its subdirectories, so the whole tree is walked concurrently
+         * while the consumer reads the entries already found.
+         *
+         * Memory follows the frontier of the walk, not the tree: nodes are
+         * released once consumed, and workers stop listing when max_ahead
+         * listed directories wait for the consumer (except the one a sorted
+         * walk waits for). An exception thrown while listing stops the walk
+         * and is rethrown by next().
+         */
+        class parallel_walker {
+            public:
+                static constexpr size_t max_ahead = 1024;
+
+                parallel_walker(const std::filesystem::path& root, size_t num_threads, walk_order order)
+                    : sorted_(order == walk_order::sorted), stop_(false), pending_(1), ahead_(0), current_index_(0) {
+                    auto node = std::make_shared<walk_node>();
+                    node->path = root;
+                    queue_.push_back(node);
+                    if (sorted_)
+                        stack_.emplace_back(node, 0);
+                    for (size_t i = 0; i < (num_threads ? num_threads : 1); i++)
+                        threads_.emplace_back([this]() { work(); });
+                }
+
+                parallel_walker(const parallel_walker&) = delete;
+
+                ~parallel_walker() {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stop_ = true;
+                    }
+                    work_cv_.notify_all();
+                    for (auto& thread : threads_)
+                        thread.join();
+                }
+
+                std::optional<walk_entry> next() {
+                    return sorted_ ? next_sorted() : next_unordered();
+                }
+
+            private:
+                std::optional<walk_entry> next_unordered() {
+                    while (!current_ || current_index_ == current_->entries.size()) {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        if (current_) {
+                            current_ = nullptr;
+                            ahead_--;
+                            work_cv_.notify_all();
+                        }
+                        ready_cv_.wait(lock, [this]() { return !done_.empty() || !pending_ || error_; });
+                        if (error_)
+                            std::rethrow_exception(error_);
+                        if (done_.empty())
+                            return std::optional<walk_entry>();
+                        current_ = done_.front();
+                        current_index_ = 0;
+                        done_.pop_front();
+                    }
+                    return std::optional<walk_entry>(current_->entries[current_index_++]);
+                }
+
+                std::optional<walk_entry> next_sorted() {
+                    while (!stack_.empty()) {
+                        walk_node* node = stack_.back().first.get();
+                        {
+                            std::unique_lock<std::mutex> lock(mutex_);
+                            if (!node->ready) {
+                                wanted_ = node;
+                                work_cv_.notify_all();
+                                ready_cv_.wait(lock, [this, node]() { return node->ready || error_; });
+                                wanted_ = nullptr;
+                            }
+                            if (error_)
+                                std::rethrow_exception(error_);
+                        }
+
+                        size_t i = stack_.back().second++;
+                        if (i == node->entries.size()) {
+                            // the node and its entries go with the last reference
+                            stack_.pop_back();
+                            std::lock_guard<std::mutex> lock(mutex_);
+                            ahead_--;
+                            work_cv_.notify_all();
+                            continue;
+                        }
+                        if (node->children[i])
+                            stack_.emplace_back(std::move(node->children[i]), 0);
+                        return std::optional<walk_entry>(node->entries[i]);
+                    }
+                    return std::optional<walk_entry>();
+                }
+
+                /**
+                 * The directory to list next, queue_.end() for none: the last
+                 * queued one, or over max_ahead only the one next_sorted
+                 * waits for.
+                 */
+                std::deque<std::shared_ptr<walk_node>>::iterator pick() {
+                    if (queue_.empty() || ahead_ < max_ahead)
+                        return queue_.empty() ? queue_.end() : queue_.end() - 1;
+                    for (auto it = queue_.end(); wanted_ && it != queue_.begin();)
+                        if ((--it)->get() == wanted_)
+                            return it;
+                    return queue_.end();
+                }
+
+                void work() {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    while (true) {
+                        work_cv_.wait(lock, [this]() { return stop_ || pick() != queue_.end() || !pending_; });
+                        if (stop_ || queue_.empty())
+                            return;
+
+                        auto picked = pick();
+                        auto node = std::move(*picked);
+                        queue_.erase(picked);
+                        ahead_++;
+                        lock.unlock();
+                        try {
+                            list(*node);
+                        }
+                        catch (...) {
+                            lock.lock();
+                            if (!error_)
+                                error_ = std::current_exception();
+                            stop_ = true;
+                            work_cv_.notify_all();
+                            ready_cv_.notify_all();
+                            return;
+                        }
+                        lock.lock();
+
+                        // reversed so that the first subdirectory is taken first
+                        for (auto child = node->children.rbegin(); child != node->children.rend(); ++child) {
+                            if (*child) {
+                                queue_.push_back(*child);
+                                pending_++;
+                            }
+                        }
+                        node->ready = true;
+                        if (!sorted_) {
+                            node->children.clear();
+                            done_.push_back(node);
+                        }
+                        pending_--;
+                        work_cv_.notify_all();
+                        ready_cv_.notify_all();
+                    }
+                }
+
+                void list(walk_node& node) {
+#if defined(__linux__)
+                    int fd = ::open(node.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                    if (fd >= 0) {
+                        alignas(struct dirent64) char buffer[1 << 15];
+                        long size;
+                        while ((size = ::syscall(SYS_getdents64, fd, buffer, sizeof(buffer))) > 0) {
+                            for (long offset = 0; offset < size;) {
+                                auto* entry = reinterpret_cast<struct dirent64*>(buffer + offset);
+                                offset += entry->d_reclen;
+                                const char* name = entry->d_name;
+                                if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+                                    continue;
+                                node.entries.push_back(walk_entry{node.path / name, file_type(fd, name, entry->d_type)});
+                            }
+                        }
+                        ::close(fd);
+                    }
+#else
+                    std::error_code ec;
+                    for (std::filesystem::directory_iterator it(node.path, ec), end; !ec && it != end; it.increment(ec))
+                        node.entries.push_back(walk_entry{it->path(), it->symlink_status(ec).type()});
+#endif
+                    if (sorted_)
+                        std::sort(node.entries.begin(), node.entries.end(), [](const walk_entry& a, const walk_entry& b) {
+                                return a.path < b.path;
+                            });
+
+                    node.children.resize(node.entries.size());
+                    for (size_t i = 0; i < node.entries.size(); i++) {
+                        if (node.entries[i].is_directory()) {
+                            node.children[i] = std::make_shared<walk_node>();
+                            node.children[i]->path = node.entries[i].path;
+                        }
+                    }
+                }
+
+#if defined(__linux__)
+                static std::filesystem::file_type file_type(int dir_fd, const char* name, unsigned char d_type) {
+                    using std::filesystem::file_type;
+                    switch (d_type) {
+                        case DT_REG: return file_type::regular;
+                        case DT_DIR: return file_type::directory;
+                        case DT_LNK: return file_type::symlink;
+                        case DT_BLK: return file_type::block;
+                        case DT_CHR: return file_type::character;
+                        case DT_FIFO: return file_type::fifo;
+                        case DT_SOCK: return file_type::socket;
+                    }
+
+                    struct stat st;
+                    if (::fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW))
+                        return file_type::unknown;
+                    if (S_ISREG(st.st_mode)) return file_type::regular;
+                    if (S_ISDIR(st.st_mode)) return file_type::directory;
+                    if (S_ISLNK(st.st_mode)) return file_type::symlink;
+                    return file_type::unknown;
+                }
+#endif
+
+                bool sorted_;
+                bool stop_;
+                size_t pending_;
+                // listed directories the consumer is not done with
+                size_t ahead_;
+                walk_node* wanted_ = nullptr;
+                std::exception_ptr error_;
+                std::mutex mutex_;
+                std::condition_variable work_cv_;
+                std::condition_variable ready_cv_;
+                std::deque<std::shared_ptr<walk_node>> queue_;
+                std::deque<std::shared_ptr<walk_node>> done_;
+                std::vector<std::thread> threads_;
+                // consumer side, only touched by next()
+                std::shared_ptr<walk_node> current_;
+                size_t current_index_;
+                std::vector<std::pair<std::shared_ptr<walk_node>, size_t>> stack_;
+        };
+    }
+
+    namespace iterators {
+        /**
+         * The walk starts on the first call to next(), copies share it.
+         */
+        class parallel_directory_iterator {
+            public:
+                typedef walk_entry value_type;
+
+                parallel_directory_iterator() = delete;
+                parallel_directory_iterator(const std::filesystem::path& path, size_t num_threads, walk_order order)
+                    : path_(path), num_threads_(num_threads), order_(order) {}
+
+                std::optional<value_type> next() {
+                    if (!walker_)
+                        walker_ = std::make_shared<detail::parallel_walker>(path_, num_threads_, order_);
+                    return walker_->next();
+                }
+
+            private:
+                std::filesystem::path path_;
+                size_t num_threads_;
+                walk_order order_;
+                std::shared_ptr<detail::parallel_walker> walker_;
+        };
+    }
+
+	namespace from {
+
+		using namespace lazypp::iterators;
+
+		/**
+		 * Recursive walk listing directories on num_threads threads, without
+		 * following symlinks. Yields walk_entry (path and type, no stat call
+		 * when the file system reports the type).
+		 */
+		inline auto parallel_directory(const std::filesystem::path& path, walk_order order = walk_order::unordered,
+				size_t num_threads = std::thread::hardware_concurrency()) {
+			return wrap(parallel_directory_iterator(path, num_threads, order));
+		}
+	}
+}
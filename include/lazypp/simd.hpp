@@ -0,0 +1,356 @@
+#pragma once
+
+/**
+ * Built-in kernels compiled for several instruction sets, the best one
+ * the host supports being picked at run time (cpuid, once): a single
+ * build uses AVX2 or AVX-512 where available without -march=native.
+ * Define LAZYPP_NO_SIMD_DISPATCH to keep to the portable kernels.
+ */
+
+#include "bits.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+
+#if !defined(LAZYPP_NO_SIMD_DISPATCH) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LAZYPP_SIMD_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace lazypp {
+
+    /**
+     * Instruction sets of the built-in kernels, each one implying the
+     * previous ones. avx512 stands for AVX-512 F and BW.
+     */
+    enum class simd_level {
+        scalar,
+        sse2,
+        avx2,
+        avx512
+    };
+
+    namespace detail {
+        inline simd_level detect_simd_level() {
+#if defined(LAZYPP_SIMD_DISPATCH)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+                return simd_level::avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return simd_level::avx2;
+            if (__builtin_cpu_supports("sse2"))
+                return simd_level::sse2;
+#endif
+            return simd_level::scalar;
+        }
+
+        inline std::atomic<simd_level>& active_level() {
+            static std::atomic<simd_level> level(detect_simd_level());
+            return level;
+        }
+    }
+
+    /**
+     * The best level the host supports.
+     */
+    inline simd_level host_simd_level() {
+        static const simd_level level = detail::detect_simd_level();
+        return level;
+    }
+
+    /**
+     * The level of the kernels iterators pick when they are built.
+     */
+    inline simd_level active_simd_level() {
+        return detail::active_level().load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Keeps the iterators built from now on to kernels of at most max (to
+     * compare or test them), returns the level actually used. Raising it
+     * again is capped by host_simd_level.
+     */
+    inline simd_level limit_simd_level(simd_level max) {
+        simd_level level = std::min(max, host_simd_level());
+        detail::active_level().store(level, std::memory_order_relaxed);
+        return level;
+    }
+
+    namespace detail {
+        /**
+         * out[k] gets the bits i set where p[i] == c[k], for the 64 bytes at
+         * p and the 3 characters of c (3 is what the CSV scanner needs).
+         */
+        typedef void (*match3_func)(const char* p, const char* c, uint64_t* out);
+
+        inline void match3_scalar(const char* p, const char* c, uint64_t* out) {
+            for (int k = 0; k < 3; k++) {
+                uint64_t mask = 0;
+                for (int i = 0; i < 64; i++)
+                    mask |= uint64_t(p[i] == c[k]) << i;
+                out[k] = mask;
+            }
+        }
+
+#if defined(LAZYPP_SIMD_DISPATCH)
+        __attribute__((target("sse2"))) inline void match3_sse2(const char* p, const char* c, uint64_t* out) {
+            __m128i chunks[4];
+            for (int i = 0; i < 4; i++)
+                chunks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+            for (int k = 0; k < 3; k++) {
+                const __m128i needle = _mm_set1_epi8(c[k]);
+                uint64_t mask = 0;
+                for (int i = 0; i < 4; i++)
+                    mask |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunks[i], needle)))) << (16 * i);
+                out[k] = mask;
+            }
+        }
+
+        __attribute__((target("avx2"))) inline void match3_avx2(const char* p, const char* c, uint64_t* out) {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32));
+            for (int k = 0; k < 3; k++) {
+                const __m256i needle = _mm256_set1_epi8(c[k]);
+                out[k] = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, needle))))
+                    | uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, needle)))) << 32;
+            }
+        }
+
+        __attribute__((target("avx512f,avx512bw"))) inline void match3_avx512(const char* p, const char* c, uint64_t* out) {
+            const __m512i chunk = _mm512_loadu_si512(p);
+            for (int k = 0; k < 3; k++)
+                out[k] = _mm512_cmpeq_epi8_mask(chunk, _mm512_set1_epi8(c[k]));
+        }
+#endif
+
+        inline match3_func match3_kernel() {
+#if defined(LAZYPP_SIMD_DISPATCH)
+            switch (active_simd_level()) {
+                case simd_level::avx512: return &match3_avx512;
+                case simd_level::avx2: return &match3_avx2;
+                case simd_level::sse2: return &match3_sse2;
+                case simd_level::scalar: break;
+            }
+#endif
+            return &match3_scalar;
+        }
+
+        /**
+         * Whether needle (m >= 2 bytes) occurs in s[0, n).
+         */
+        typedef bool (*find_func)(const char* s, size_t n, const char* needle, size_t m);
+
+        inline bool find_scalar(const char* s, size_t n, const char* needle, size_t m) {
+            return std::string_view(s, n).find(std::string_view(needle, m)) != std::string_view::npos;
+        }
+
+        /**
+         * Checks the candidates of a block, bit i set when s[i] and
+         * s[i + m - 1] are the first and last bytes of needle.
+         */
+        inline bool verify_candidates(uint64_t candidates, const char* s, const char* needle, size_t m) {
+            for (; candidates; candidates &= candidates - 1)
+                if (std::memcmp(s + count_trailing_zeros(candidates) + 1, needle + 1, m - 2) == 0)
+                    return true;
+            return false;
+        }
+
+        /**
+         * Whether s[0, m) equals needle, m <= 64, n >= m. padded holds the
+         * needle in 64 bytes (64-aligned), zeros after it.
+         */
+        typedef bool (*prefix_func)(const char* s, size_t n, const char* padded, size_t m);
+
+        inline bool prefix_scalar(const char* s, size_t, const char* padded, size_t m) {
+            return std::memcmp(s, padded, m) == 0;
+        }
+
+#if defined(LAZYPP_SIMD_DISPATCH)
+        /**
+         * First and last byte matching: a block of positions is compared
+         * against needle's first byte and, m - 1 bytes further, against its
+         * last one, only the positions matching both are compared in full.
+         * The last block overlaps the previous one (AVX-512 masks it
+         * instead), strings shorter than a block go to the next narrower
+         * kernel.
+         */
+        __attribute__((target("sse2"))) inline bool find_sse2(const char* s, size_t n, const char* needle, size_t m) {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[m - 1]);
+            if (n < m - 1 + 16)
+                return find_scalar(s, n, needle, m);
+            for (size_t i = 0; ; i += 16) {
+                i = std::min(i, n - (m - 1 + 16));
+                __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), first);
+                __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + m - 1)), last);
+                if (verify_candidates(uint16_t(_mm_movemask_epi8(_mm_and_si128(a, b))), s + i, needle, m))
+                    return true;
+                if (i == n - (m - 1 + 16))
+                    return false;
+            }
+        }
+
+        __attribute__((target("avx2"))) inline bool find_avx2(const char* s, size_t n, const char* needle, size_t m) {
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last = _mm256_set1_epi8(needle[m - 1]);
+            if (n < m - 1 + 32)
+                return find_sse2(s, n, needle, m);
+            for (size_t i = 0; ; i += 32) {
+                i = std::min(i, n - (m - 1 + 32));
+                __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)), first);
+                __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + m - 1)), last);
+                if (verify_candidates(uint32_t(_mm256_movemask_epi8(_mm256_and_si256(a, b))), s + i, needle, m))
+                    return true;
+                if (i == n - (m - 1 + 32))
+                    return false;
+            }
+        }
+
+        __attribute__((target("avx512f,avx512bw"))) inline bool find_avx512(const char* s, size_t n, const char* needle, size_t m) {
+            const __m512i first = _mm512_set1_epi8(needle[0]);
+            const __m512i last = _mm512_set1_epi8(needle[m - 1]);
+            if (n < m)
+                return false;
+            size_t i = 0;
+            for (; i + m - 1 + 64 <= n; i += 64) {
+                uint64_t a = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i), first);
+                uint64_t b = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(s + i + m - 1), last);
+                if (verify_candidates(a & b, s + i, needle, m))
+                    return true;
+            }
+            // fewer than 64 positions left
+            __mmask64 positions = low_bits_mask(unsigned(n - m + 1 - i));
+            uint64_t a = _mm512_mask_cmpeq_epi8_mask(positions, _mm512_maskz_loadu_epi8(positions, s + i), first);
+            uint64_t b = _mm512_mask_cmpeq_epi8_mask(positions, _mm512_maskz_loadu_epi8(positions, s + i + m - 1), last);
+            return verify_candidates(a & b, s + i, needle, m);
+        }
+
+        /**
+         * The needle's blocks against s's, when s has whole blocks to load
+         * (memcmp otherwise).
+         */
+        __attribute__((target("sse2"))) inline bool prefix_sse2(const char* s, size_t n, const char* padded, size_t m) {
+            if (n < (m + 15) / 16 * 16)
+                return std::memcmp(s, padded, m) == 0;
+            for (size_t i = 0; i < m; i += 16) {
+                uint32_t wanted = uint32_t(low_bits_mask(unsigned(std::min<size_t>(m - i, 16))));
+                __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)),
+                        _mm_load_si128(reinterpret_cast<const __m128i*>(padded + i)));
+                if ((uint32_t(_mm_movemask_epi8(eq)) & wanted) != wanted)
+                    return false;
+            }
+            return true;
+        }
+
+        __attribute__((target("avx2"))) inline bool prefix_avx2(const char* s, size_t n, const char* padded, size_t m) {
+            if (n < (m + 31) / 32 * 32)
+                return std::memcmp(s, padded, m) == 0;
+            for (size_t i = 0; i < m; i += 32) {
+                uint32_t wanted = uint32_t(low_bits_mask(unsigned(std::min<size_t>(m - i, 32))));
+                __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)),
+                        _mm256_load_si256(reinterpret_cast<const __m256i*>(padded + i)));
+                if ((uint32_t(_mm256_movemask_epi8(eq)) & wanted) != wanted)
+                    return false;
+            }
+            return true;
+        }
+
+        /**
+         * A masked load never touches the bytes past m, whatever n.
+         */
+        __attribute__((target("avx512f,avx512bw"))) inline bool prefix_avx512(const char* s, size_t, const char* padded, size_t m) {
+            __mmask64 wanted = low_bits_mask(unsigned(m));
+            return _mm512_mask_cmpneq_epi8_mask(wanted, _mm512_maskz_loadu_epi8(wanted, s), _mm512_load_si512(padded)) == 0;
+        }
+#endif
+
+        inline find_func find_kernel() {
+#if defined(LAZYPP_SIMD_DISPATCH)
+            switch (active_simd_level()) {
+                case simd_level::avx512: return &find_avx512;
+                case simd_level::avx2: return &find_avx2;
+                case simd_level::sse2: return &find_sse2;
+                case simd_level::scalar: break;
+            }
+#endif
+            return &find_scalar;
+        }
+
+        inline prefix_func prefix_kernel() {
+#if defined(LAZYPP_SIMD_DISPATCH)
+            switch (active_simd_level()) {
+                case simd_level::avx512: return &prefix_avx512;
+                case simd_level::avx2: return &prefix_avx2;
+                case simd_level::sse2: return &prefix_sse2;
+                case simd_level::scalar: break;
+            }
+#endif
+            return &prefix_scalar;
+        }
+
+#if defined(LAZYPP_SIMD_DISPATCH)
+        /**
+         * Any width from 1 to 64: value k is gathered from word k * bits / 64,
+         * plus the next one for the values straddling two words (a masked
+         * gather, so nothing past the block is read).
+         */
+        __attribute__((target("avx2"))) inline void unpack_block_avx2(const uint64_t* words, uint64_t* out, unsigned bits) {
+            const __m256i mask = _mm256_set1_epi64x(int64_t(low_bits_mask(bits)));
+            const __m256i steps = _mm256_set_epi64x(3 * bits, 2 * bits, bits, 0);
+            const __m256i width = _mm256_set1_epi64x(bits);
+            const __m256i sixty_four = _mm256_set1_epi64x(64);
+            const long long* base = reinterpret_cast<const long long*>(words);
+            for (unsigned k = 0; k < 64; k += 4) {
+                __m256i bit = _mm256_add_epi64(_mm256_set1_epi64x(int64_t(k) * bits), steps);
+                __m256i index = _mm256_srli_epi64(bit, 6);
+                __m256i offset = _mm256_and_si256(bit, _mm256_set1_epi64x(63));
+                __m256i straddles = _mm256_cmpgt_epi64(_mm256_add_epi64(offset, width), sixty_four);
+                __m256i low = _mm256_i64gather_epi64(base, index, 8);
+                __m256i high = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), base + 1, index, straddles, 8);
+                __m256i v = _mm256_or_si256(_mm256_srlv_epi64(low, offset), _mm256_sllv_epi64(high, _mm256_sub_epi64(sixty_four, offset)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k), _mm256_and_si256(v, mask));
+            }
+        }
+
+        // GCC 12's AVX-512 intrinsics start from a self-initialized
+        // _mm512_undefined, which -Wuninitialized reports once inlined.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+        __attribute__((target("avx512f"))) inline void unpack_block_avx512(const uint64_t* words, uint64_t* out, unsigned bits) {
+            const __m512i mask = _mm512_set1_epi64(int64_t(low_bits_mask(bits)));
+            const __m512i steps = _mm512_set_epi64(7 * bits, 6 * bits, 5 * bits, 4 * bits, 3 * bits, 2 * bits, bits, 0);
+            const __m512i width = _mm512_set1_epi64(bits);
+            const __m512i sixty_four = _mm512_set1_epi64(64);
+            for (unsigned k = 0; k < 64; k += 8) {
+                __m512i bit = _mm512_add_epi64(_mm512_set1_epi64(int64_t(k) * bits), steps);
+                __m512i index = _mm512_srli_epi64(bit, 6);
+                __m512i offset = _mm512_and_si512(bit, _mm512_set1_epi64(63));
+                __mmask8 straddles = _mm512_cmpgt_epi64_mask(_mm512_add_epi64(offset, width), sixty_four);
+                __m512i low = _mm512_i64gather_epi64(index, words, 8);
+                __m512i high = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), straddles, index, words + 1, 8);
+                __m512i v = _mm512_or_si512(_mm512_srlv_epi64(low, offset), _mm512_sllv_epi64(high, _mm512_sub_epi64(sixty_four, offset)));
+                _mm512_storeu_si512(out + k, _mm512_and_si512(v, mask));
+            }
+        }
+#pragma GCC diagnostic pop
+#endif
+
+        /**
+         * Kernel unpacking 64 values of bits bits. Widths 0, 1 and 64 are
+         * plain copies or shifts, the specialized scalar kernels win there.
+         */
+        inline unpack_block_func unpack_kernel(unsigned bits) {
+#if defined(LAZYPP_SIMD_DISPATCH)
+            if (bits > 1 && bits < 64)
+                switch (active_simd_level()) {
+                    case simd_level::avx512: return &unpack_block_avx512;
+                    case simd_level::avx2: return &unpack_block_avx2;
+                    default: break;
+                }
+#endif
+            return unpack_table()[bits];
+        }
+    }
+}
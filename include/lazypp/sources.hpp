@@ -0,0 +1,476 @@
+#pragma once
+
+/**
+ * Sources computed in memory: random sequences, grids and matrices,
+ * linked structures and the set bits of bitmaps.
+ */
+
+#include "core.hpp"
+#include "bits.hpp"
+
+#include <bitset>
+#include <cmath>
+#include <tuple>
+
+namespace lazypp {
+
+    /**
+     * Stateless distributions: they map one 64 bit random word to one value,
+     * so blocks of them can be generated without loop carried dependencies.
+     */
+    namespace distributions {
+        template<typename T>
+            struct uniform_bits {
+                constexpr T operator()(uint64_t bits) const {
+                    return static_cast<T>(bits);
+                }
+            };
+
+        /**
+         * Floating point values in [a, b), integers in [a, b] (like
+         * std::uniform_int_distribution), the latter scaling the word by
+         * the range with a multiply-shift (Lemire), bias below 2^-64 / range.
+         */
+        template<typename T>
+            struct uniform {
+                constexpr uniform(T a = T(0), T b = T(1)) : a_(a), b_(b) {}
+
+                constexpr T operator()(uint64_t bits) const {
+                    if constexpr (std::is_integral<T>::value) {
+                        // b - a + 1 in 64 bits, 0 for the whole 64 bit range
+                        const uint64_t range = uint64_t(b_) - uint64_t(a_) + 1;
+                        return T(uint64_t(a_) + (range ? detail::mul_high64(bits, range) : bits));
+                    }
+                    else
+                        return a_ + (b_ - a_) * detail::to_unit<T>(bits);
+                }
+
+                T a_;
+                T b_;
+            };
+
+        /**
+         * Box-Muller using both 32 bit halves of the random word, only the
+         * cosine branch is used so each value depends on one word.
+         */
+        template<typename T>
+            struct normal {
+                normal(T mean = T(0), T stddev = T(1)) : mean_(mean), stddev_(stddev) {}
+
+                T operator()(uint64_t bits) const {
+                    const T u1 = (T(bits >> 32) + T(1)) * T(1.0 / 4294967296.0);
+                    const T u2 = T(bits & 0xffffffffull) * T(1.0 / 4294967296.0);
+                    return mean_ + stddev_ * std::sqrt(T(-2) * std::log(u1)) * std::cos(T(6.283185307179586) * u2);
+                }
+
+                T mean_;
+                T stddev_;
+            };
+
+        template<typename T>
+            using default_t = std::conditional_t<std::is_floating_point<T>::value, uniform<T>, uniform_bits<T>>;
+    }
+
+    /**
+     * Visiting order of 2D sources. tiled visits square blocks one after the
+     * other (row major inside each block and between blocks).
+     */
+    enum class traversal {
+        row_major,
+        column_major,
+        tiled
+    };
+
+    /**
+     * Rows [row_begin, row_end) x columns [col_begin, col_end).
+     */
+    struct grid_region {
+        size_t row_begin;
+        size_t row_end;
+        size_t col_begin;
+        size_t col_end;
+
+        size_t size() const {
+            return row_end > row_begin && col_end > col_begin ? (row_end - row_begin) * (col_end - col_begin) : 0;
+        }
+    };
+
+    namespace iterators {
+        /**
+         * Counter based random engine (UniformRandomBitGenerator): output k of
+         * stream s is a pure function of (seed, s, k), so seeking is O(1) and
+         * distinct streams never overlap.
+         */
+        class counter_engine {
+            public:
+                typedef uint64_t result_type;
+
+                static constexpr result_type min() { return 0; }
+                static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+                constexpr counter_engine(uint64_t seed = 0, uint64_t stream = 0)
+                    : key_(detail::mix64(detail::mix64(seed) ^ (stream * detail::golden_gamma + 1))), counter_(0) {}
+
+                constexpr result_type operator()() {
+                    return detail::mix64(key_ + ++counter_ * detail::golden_gamma);
+                }
+
+                constexpr void discard(uint64_t n) {
+                    counter_ += n;
+                }
+
+            private:
+                uint64_t key_;
+                uint64_t counter_;
+        };
+
+        /**
+         * Element i of the sequence only depends on (seed, i): stateless
+         * distributions get the i-th word of a single stream, any other
+         * distribution (std::normal_distribution...) gets a fresh copy of
+         * itself and its own stream i. That makes the source random access and
+         * gives the same values whatever way it is split between workers.
+         */
+        template<typename T, typename Distribution>
+            class random_iterator {
+                public:
+                    typedef T value_type;
+
+                    random_iterator() = delete;
+                    random_iterator(uint64_t seed, Distribution distribution, uint64_t first = 0)
+                        : seed_(seed), key_(detail::mix64(seed)), distribution_(distribution), index_(first) {}
+
+                    std::optional<value_type> next() {
+                        return std::optional<value_type>(at(index_++));
+                    }
+
+                    value_type at(uint64_t i) const {
+                        return generate(i, std::is_invocable<const Distribution&, uint64_t>());
+                    }
+
+                    uint64_t index() const {
+                        return index_;
+                    }
+
+                    void seek(uint64_t i) {
+                        index_ = i;
+                    }
+
+                    /**
+                     * Block generation: writes the next n values to out. A plain
+                     * loop over at(), with no loop carried dependency for the
+                     * stateless distributions, so the compiler can vectorize it
+                     * where the vectorizer is on (-O3).
+                     */
+                    void fill(value_type* out, size_t n) {
+                        const uint64_t first = index_;
+                        for (size_t k = 0; k < n; k++)
+                            out[k] = at(first + k);
+                        index_ += n;
+                    }
+
+                private:
+                    value_type generate(uint64_t i, std::true_type) const {
+                        return static_cast<value_type>(distribution_(detail::mix64(key_ + i * detail::golden_gamma)));
+                    }
+
+                    value_type generate(uint64_t i, std::false_type) const {
+                        counter_engine engine(seed_, i);
+                        Distribution distribution(distribution_);
+                        return static_cast<value_type>(distribution(engine));
+                    }
+
+                    uint64_t seed_;
+                    uint64_t key_;
+                    Distribution distribution_;
+                    uint64_t index_;
+            };
+
+        /**
+         * Yields the indices of the set bits of a bitmap, one 64 bit word at a
+         * time: zero words cost one test and each set bit one ctz.
+         * WordFunc(k) returns the k-th word, bits past num_bits are ignored.
+         */
+        template<typename WordFunc>
+            class set_bits_iterator {
+                public:
+                    typedef size_t value_type;
+
+                    set_bits_iterator() = delete;
+                    set_bits_iterator(WordFunc word_func, size_t num_bits)
+                        : word_func_(word_func), num_bits_(num_bits), num_words_((num_bits + 63) / 64), word_index_(size_t(-1)), word_(0) {}
+
+                    std::optional<value_type> next() {
+                        while (!word_) {
+                            if (++word_index_ >= num_words_) {
+                                word_index_ = num_words_;
+                                return std::optional<value_type>();
+                            }
+                            word_ = word_func_(word_index_);
+                            if (word_index_ == num_words_ - 1 && num_bits_ % 64)
+                                word_ &= (uint64_t(1) << (num_bits_ % 64)) - 1;
+                        }
+
+                        size_t bit = word_index_ * 64 + detail::count_trailing_zeros(word_);
+                        word_ &= word_ - 1;
+                        return std::optional<value_type>(bit);
+                    }
+
+                private:
+                    WordFunc word_func_;
+                    size_t num_bits_;
+                    size_t num_words_;
+                    size_t word_index_;
+                    uint64_t word_;
+            };
+
+        /**
+         * Walks a linked structure from head following NextFunc, prefetching
+         * the next node while the current one is being consumed.
+         */
+        template<typename Node, typename NextFunc>
+            class linked_iterator {
+                public:
+                    typedef Node* value_type;
+
+                    linked_iterator() = delete;
+                    linked_iterator(Node* head, NextFunc next_func) : actual_(head), next_func_(next_func) {}
+
+                    std::optional<value_type> next() {
+                        if (!actual_)
+                            return std::optional<value_type>();
+
+                        Node* node = actual_;
+                        actual_ = next_func_(node);
+                        LAZYPP_PREFETCH(actual_);
+                        return std::optional<value_type>(node);
+                    }
+
+                private:
+                    Node* actual_;
+                    NextFunc next_func_;
+            };
+
+        /**
+         * Yields the (row, column) coordinates of a region in the given
+         * traversal order. row_major is a single tile covering the region.
+         */
+        class grid_iterator {
+            public:
+                typedef std::tuple<size_t, size_t> value_type;
+
+                grid_iterator() = delete;
+                grid_iterator(grid_region region, traversal order, size_t tile)
+                    : region_(region), column_major_(order == traversal::column_major),
+                      tile_rows_(order == traversal::tiled && tile ? tile : region.row_end - region.row_begin),
+                      tile_cols_(order == traversal::tiled && tile ? tile : region.col_end - region.col_begin),
+                      tile_row_(region.row_begin), tile_col_(region.col_begin),
+                      row_(region.row_begin), col_(region.col_begin), remaining_(region.size()) {}
+
+                std::optional<value_type> next() {
+                    if (!remaining_)
+                        return std::optional<value_type>();
+
+                    value_type v(row_, col_);
+                    remaining_--;
+                    if (column_major_)
+                        advance_column_major();
+                    else
+                        advance_tiled();
+                    return std::optional<value_type>(v);
+                }
+
+                /**
+                 * Number of coordinates left.
+                 */
+                size_t size() const {
+                    return remaining_;
+                }
+
+            private:
+                void advance_column_major() {
+                    if (++row_ == region_.row_end) {
+                        row_ = region_.row_begin;
+                        col_++;
+                    }
+                }
+
+                void advance_tiled() {
+                    if (++col_ < std::min(tile_col_ + tile_cols_, region_.col_end))
+                        return;
+                    col_ = tile_col_;
+                    if (++row_ < std::min(tile_row_ + tile_rows_, region_.row_end))
+                        return;
+                    tile_col_ += tile_cols_;
+                    if (tile_col_ >= region_.col_end) {
+                        tile_col_ = region_.col_begin;
+                        tile_row_ += tile_rows_;
+                    }
+                    row_ = tile_row_;
+                    col_ = tile_col_;
+                }
+
+                grid_region region_;
+                bool column_major_;
+                size_t tile_rows_;
+                size_t tile_cols_;
+                size_t tile_row_;
+                size_t tile_col_;
+                size_t row_;
+                size_t col_;
+                size_t remaining_;
+        };
+
+        /**
+         * Yields (row, column, element reference) of a strided matrix.
+         */
+        template<typename T>
+            class matrix_iterator {
+                public:
+                    typedef std::tuple<size_t, size_t, T&> value_type;
+
+                    matrix_iterator() = delete;
+                    matrix_iterator(T* data, size_t stride, grid_iterator grid) : data_(data), stride_(stride), grid_(grid) {}
+
+                    std::optional<value_type> next() {
+                        auto v = grid_.next();
+                        if (!v)
+                            return std::optional<value_type>();
+
+                        size_t i = std::get<0>(*v);
+                        size_t j = std::get<1>(*v);
+                        return std::optional<value_type>(value_type(i, j, data_[i * stride_ + j]));
+                    }
+
+                    size_t size() const {
+                        return grid_.size();
+                    }
+
+                private:
+                    T* data_;
+                    size_t stride_;
+                    grid_iterator grid_;
+            };
+    }
+
+	namespace from {
+
+		using namespace lazypp::iterators;
+
+		/**
+		 * Infinite random sequence, element i only depends on (seed, i). Use
+		 * first to start at any position (e.g. one slice per worker).
+		 */
+		template<typename T, typename Distribution>
+			auto random(uint64_t seed, Distribution distribution, uint64_t first = 0) {
+				return wrap(random_iterator<T, Distribution>(seed, distribution, first));
+			}
+
+		template<typename T>
+			auto random(uint64_t seed) {
+				return random<T>(seed, distributions::default_t<T>());
+			}
+
+		template<typename Node, typename NextFunc>
+			auto linked(Node* head, NextFunc next_func) {
+				return wrap(linked_iterator<Node, NextFunc>(head, next_func));
+			}
+
+		/**
+		 * Coordinates (i, j) of a w x h grid, i being the row.
+		 */
+		inline auto grid(grid_region region, traversal order = traversal::row_major, size_t tile = 32) {
+			return wrap(grid_iterator(region, order, tile));
+		}
+
+		inline auto grid(size_t w, size_t h, traversal order = traversal::row_major, size_t tile = 32) {
+			return grid(grid_region{0, h, 0, w}, order, tile);
+		}
+
+		/**
+		 * Splits a w x h grid into tile_w x tile_h regions, each of them can be
+		 * traversed independently (e.g. one per worker) with grid or
+		 * matrix_view.
+		 */
+		inline auto tiles(size_t w, size_t h, size_t tile_w, size_t tile_h) {
+			return grid((w + tile_w - 1) / tile_w, (h + tile_h - 1) / tile_h)
+				.map([w, h, tile_w, tile_h](const std::tuple<size_t, size_t>& t) {
+					size_t row = std::get<0>(t) * tile_h;
+					size_t col = std::get<1>(t) * tile_w;
+					return grid_region{row, std::min(row + tile_h, h), col, std::min(col + tile_w, w)};
+				});
+		}
+
+		/**
+		 * Elements of a rows x cols matrix whose rows are stride elements
+		 * apart, as (i, j, value) tuples.
+		 */
+		template<typename T>
+			auto matrix_view(T* data, size_t stride, grid_region region, traversal order = traversal::row_major, size_t tile = 32) {
+				return wrap(matrix_iterator<T>(data, stride, grid_iterator(region, order, tile)));
+			}
+
+		template<typename T>
+			auto matrix_view(T* data, size_t rows, size_t cols, size_t stride, traversal order = traversal::row_major, size_t tile = 32) {
+				return matrix_view(data, stride, grid_region{0, rows, 0, cols}, order, tile);
+			}
+
+		inline auto set_bits(const uint64_t* words, size_t num_words) {
+			auto word_func = [words](size_t k) { return words[k]; };
+			return wrap(set_bits_iterator<decltype(word_func)>(word_func, num_words * 64));
+		}
+
+		inline auto set_bits(const std::vector<uint64_t>& words) {
+			return set_bits(words.data(), words.size());
+		}
+
+		/**
+		 * std::bitset has no access to its words. With libstdc++ the set bits
+		 * are found with _Find_next (a ctz per word), the next one being kept
+		 * so that words without set bits cost a comparison; elsewhere each
+		 * word is assembled bit by bit, 64 tests per word.
+		 */
+		template<size_t N>
+			auto set_bits(const std::bitset<N>& bits) {
+#if defined(__GLIBCXX__)
+				auto word_func = [&bits, next = bits._Find_first()](size_t k) mutable {
+					uint64_t word = 0;
+					const size_t last = std::min(N, k * 64 + 64);
+					for (; next < last; next = bits._Find_next(next))
+						word |= uint64_t(1) << (next % 64);
+					return word;
+				};
+#else
+				auto word_func = [&bits](size_t k) {
+					uint64_t word = 0;
+					size_t last = std::min(N, k * 64 + 64);
+					for (size_t i = k * 64; i < last; i++)
+						word |= uint64_t(bits[i]) << (i % 64);
+					return word;
+				};
+#endif
+				return wrap(set_bits_iterator<decltype(word_func)>(word_func, N));
+			}
+
+		/**
+		 * With libstdc++ (64 bit words) the words of the vector are read
+		 * directly, otherwise they are assembled bit by bit.
+		 */
+		inline auto set_bits(const std::vector<bool>& bits) {
+#if defined(__GLIBCXX__) && (__SIZEOF_LONG__ == 8)
+			static_assert(sizeof(std::_Bit_type) == sizeof(uint64_t), "64 bit words expected");
+			const std::_Bit_type* words = bits.begin()._M_p;
+			auto word_func = [words](size_t k) { return uint64_t(words[k]); };
+#else
+			auto word_func = [&bits](size_t k) {
+				uint64_t word = 0;
+				size_t last = std::min(bits.size(), k * 64 + 64);
+				for (size_t i = k * 64; i < last; i++)
+					word |= uint64_t(bits[i]) << (i % 64);
+				return word;
+			};
+#endif
+			return wrap(set_bits_iterator<decltype(word_func)>(word_func, bits.size()));
+		}
+	}
+}
@@ -0,0 +1,383 @@
+#pragma once
+
+/**
+ * Predicates on strings for filter, over the string_view elements of
+ * from::lines, chunk_lines or CSV fields (or std::string ones):
+ * where::contains, where::starts_with and where::equals_any, also
+ * reachable as the filter_contains, filter_prefix and filter_equals_any
+ * stages. Needles are prepared once, when the predicate is built, and
+ * matched with the kernels of simd.hpp.
+ *
+ * Many patterns at once: pattern_set, an Aho-Corasick automaton scanning
+ * each string in one pass, behind where::matches_any and the match_any
+ * and tag_matches stages.
+ */
+
+#include "core.hpp"
+#include "simd.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+namespace lazypp {
+
+    namespace detail {
+        /**
+         * The strings of where::equals_any, shared by the copies of the
+         * predicate. Lengths and first and last bytes no string has reject
+         * most values before the strings are compared, one by one for a
+         * few strings, through a hash set otherwise.
+         */
+        class string_set {
+            public:
+                template<typename Strings>
+                    explicit string_set(const Strings& strings) : lengths_(0), first_{}, last_{} {
+                        for (auto&& s : strings)
+                            strings_.emplace_back(std::string_view(s));
+                        // views into strings_, which no longer changes
+                        for (const std::string& s : strings_) {
+                            lengths_ |= uint64_t(1) << std::min<size_t>(s.size(), 63);
+                            if (!s.empty()) {
+                                add(first_, s.front());
+                                add(last_, s.back());
+                            }
+                            if (strings_.size() > linear_max)
+                                views_.insert(s);
+                        }
+                    }
+                string_set(const string_set&) = delete;
+
+                bool contains(std::string_view s) const {
+                    if (!(lengths_ >> std::min<size_t>(s.size(), 63) & 1))
+                        return false;
+                    if (!s.empty() && !(has(first_, s.front()) && has(last_, s.back())))
+                        return false;
+                    if (strings_.size() <= linear_max)
+                        return std::find(strings_.begin(), strings_.end(), s) != strings_.end();
+                    return views_.count(s) != 0;
+                }
+
+            private:
+                static constexpr size_t linear_max = 8;
+
+                static void add(uint64_t* bytes, char c) {
+                    bytes[uint8_t(c) / 64] |= uint64_t(1) << (uint8_t(c) % 64);
+                }
+
+                static bool has(const uint64_t* bytes, char c) {
+                    return bytes[uint8_t(c) / 64] >> (uint8_t(c) % 64) & 1;
+                }
+
+                std::vector<std::string> strings_;
+                std::unordered_set<std::string_view> views_;
+                uint64_t lengths_;
+                uint64_t first_[4];
+                uint64_t last_[4];
+        };
+
+        /**
+         * Aho-Corasick automaton, built once and shared by the copies of a
+         * pattern_set. The failure links are folded into a complete
+         * transition table, so scanning is one lookup per byte:
+         *  - bytes are mapped to classes first (class 0: bytes of no
+         *    pattern), rows have one entry per class instead of 256;
+         *  - states are numbered breadth first, the shallow states most
+         *    bytes stay in share a few cache lines;
+         *  - entries hold the target row's offset, with the high bit set
+         *    when the target state ends a pattern.
+         */
+        class aho_corasick {
+            public:
+                template<typename Patterns>
+                    explicit aho_corasick(const Patterns& patterns) : classes_{}, num_classes_(1) {
+                        std::vector<std::string> strings;
+                        for (auto&& p : patterns)
+                            strings.emplace_back(std::string_view(p));
+                        for (const std::string& p : strings)
+                            for (char c : p)
+                                if (!classes_[uint8_t(c)])
+                                    classes_[uint8_t(c)] = uint16_t(num_classes_++);
+                        build(strings);
+                    }
+                aho_corasick(const aho_corasick&) = delete;
+
+                size_t size() const {
+                    return size_;
+                }
+
+                bool contains_any(std::string_view s) const {
+                    if (out_begin_[1])
+                        return true;
+                    const uint32_t* next = next_.data();
+                    uint32_t state = 0;
+                    for (char c : s) {
+                        state = next[state + classes_[uint8_t(c)]];
+                        if (state & match_flag)
+                            return true;
+                    }
+                    return false;
+                }
+
+                /**
+                 * f(id, end) for each occurrence of a pattern ending at
+                 * s[end - 1], until it returns false.
+                 */
+                template<typename Func>
+                    void each_match(std::string_view s, Func&& f) const {
+                        if (!report(0, 0, f))
+                            return;
+                        const uint32_t* next = next_.data();
+                        uint32_t state = 0;
+                        for (size_t i = 0; i < s.size(); i++) {
+                            state = next[state + classes_[uint8_t(s[i])]];
+                            if (state & match_flag) {
+                                state &= ~match_flag;
+                                if (!report(state / num_classes_, i + 1, f))
+                                    return;
+                            }
+                        }
+                    }
+
+            private:
+                static constexpr uint32_t match_flag = uint32_t(1) << 31;
+                static constexpr uint32_t none = ~uint32_t(0);
+
+                void build(const std::vector<std::string>& strings) {
+                    const size_t c = num_classes_;
+                    size_ = strings.size();
+
+                    // trie, states in insertion order
+                    std::vector<uint32_t> go(c, none);
+                    std::vector<std::vector<uint32_t>> out(1);
+                    for (size_t id = 0; id < strings.size(); id++) {
+                        size_t state = 0;
+                        for (char ch : strings[id]) {
+                            size_t edge = state * c + classes_[uint8_t(ch)];
+                            if (go[edge] == none) {
+                                go[edge] = uint32_t(out.size());
+                                out.emplace_back();
+                                go.resize(go.size() + c, none);
+                            }
+                            state = go[edge];
+                        }
+                        out[state].push_back(uint32_t(id));
+                    }
+                    if (out.size() * c >= match_flag)
+                        throw std::length_error("lazypp: too many patterns for a pattern_set");
+
+                    // breadth first: failure links, folded into the missing
+                    // transitions, and the outputs of the failure states
+                    std::vector<uint32_t> fail(out.size(), 0);
+                    std::vector<uint32_t> order(1, 0);
+                    order.reserve(out.size());
+                    for (size_t k = 0; k < order.size(); k++) {
+                        uint32_t state = order[k];
+                        for (size_t x = 0; x < c; x++) {
+                            uint32_t fallback = state ? go[fail[state] * c + x] : 0;
+                            uint32_t& target = go[state * c + x];
+                            if (target == none)
+                                target = fallback;
+                            else {
+                                fail[target] = fallback;
+                                out[target].insert(out[target].end(), out[fallback].begin(), out[fallback].end());
+                                order.push_back(target);
+                            }
+                        }
+                    }
+
+                    std::vector<uint32_t> rank(out.size());
+                    for (size_t k = 0; k < order.size(); k++)
+                        rank[order[k]] = uint32_t(k);
+                    next_.resize(out.size() * c);
+                    out_begin_.reserve(out.size() + 1);
+                    for (size_t k = 0; k < order.size(); k++) {
+                        for (size_t x = 0; x < c; x++) {
+                            uint32_t target = go[order[k] * c + x];
+                            next_[k * c + x] = uint32_t(rank[target] * c) | (out[target].empty() ? 0 : match_flag);
+                        }
+                        out_begin_.push_back(uint32_t(out_ids_.size()));
+                        out_ids_.insert(out_ids_.end(), out[order[k]].begin(), out[order[k]].end());
+                    }
+                    out_begin_.push_back(uint32_t(out_ids_.size()));
+                }
+
+                template<typename Func>
+                    bool report(size_t state, size_t end, Func& f) const {
+                        for (uint32_t k = out_begin_[state]; k < out_begin_[state + 1]; k++)
+                            if (!f(size_t(out_ids_[k]), end))
+                                return false;
+                        return true;
+                    }
+
+                uint16_t classes_[256];
+                size_t num_classes_;
+                size_t size_;
+                std::vector<uint32_t> next_;
+                std::vector<uint32_t> out_begin_;
+                std::vector<uint32_t> out_ids_;
+        };
+    }
+
+    /**
+     * Patterns searched for all at once, identified by their index in the
+     * range they are built from. Building it is the costly part: build one
+     * and pass it to several match_any / tag_matches stages, copies share
+     * the automaton.
+     */
+    class pattern_set {
+        public:
+            template<typename Patterns>
+                explicit pattern_set(const Patterns& patterns) : automaton_(std::make_shared<const detail::aho_corasick>(patterns)) {}
+            pattern_set(std::initializer_list<std::string_view> patterns)
+                : automaton_(std::make_shared<const detail::aho_corasick>(patterns)) {}
+
+            size_t size() const {
+                return automaton_->size();
+            }
+
+            /**
+             * Whether s contains one of the patterns, stopping at the first.
+             */
+            bool contains_any(std::string_view s) const {
+                return automaton_->contains_any(s);
+            }
+
+            /**
+             * The ids of the patterns s contains, in increasing order.
+             */
+            std::vector<size_t> matches(std::string_view s) const {
+                std::vector<size_t> ids;
+                automaton_->each_match(s, [&ids](size_t id, size_t) {
+                        ids.push_back(id);
+                        return true;
+                    });
+                std::sort(ids.begin(), ids.end());
+                ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+                return ids;
+            }
+
+            /**
+             * f(id, end) for every occurrence, pattern id ending at
+             * s[end - 1], in the order of end; f returns false to stop.
+             */
+            template<typename Func>
+                void each_match(std::string_view s, Func f) const {
+                    automaton_->each_match(s, f);
+                }
+
+        private:
+            std::shared_ptr<const detail::aho_corasick> automaton_;
+    };
+
+    namespace where {
+        /**
+         * Strings containing needle: blocks of 16 to 64 positions (by
+         * simd_level) are matched against needle's first and last bytes,
+         * only the candidates are compared in full.
+         */
+        class contains {
+            public:
+                contains(std::string_view needle) : needle_(needle), find_(detail::find_kernel()) {}
+
+                bool operator()(std::string_view s) const {
+                    if (needle_.size() < 2)
+                        return needle_.empty() || (!s.empty() && std::memchr(s.data(), needle_[0], s.size()));
+                    return find_(s.data(), s.size(), needle_.data(), needle_.size());
+                }
+
+            private:
+                std::string needle_;
+                detail::find_func find_;
+        };
+
+        /**
+         * Strings starting with prefix. Prefixes up to 64 bytes are kept in
+         * a vector register sized buffer and compared a block at a time.
+         */
+        class starts_with {
+            public:
+                starts_with(std::string_view prefix) : prefix_(prefix), padded_{}, prefix_func_(detail::prefix_kernel()) {
+                    std::memcpy(padded_, prefix.data(), std::min<size_t>(prefix.size(), 64));
+                }
+
+                bool operator()(std::string_view s) const {
+                    if (s.size() < prefix_.size())
+                        return false;
+                    if (prefix_.size() > 64)
+                        return std::memcmp(s.data(), prefix_.data(), prefix_.size()) == 0;
+                    return prefix_func_(s.data(), s.size(), padded_, prefix_.size());
+                }
+
+            private:
+                std::string prefix_;
+                alignas(64) char padded_[64];
+                detail::prefix_func prefix_func_;
+        };
+
+        /**
+         * Strings equal to one of a set (any range of things string_view is
+         * built from), e.g. where::equals_any({"GET", "HEAD"}).
+         */
+        class equals_any {
+            public:
+                template<typename Strings>
+                    equals_any(const Strings& strings) : set_(std::make_shared<const detail::string_set>(strings)) {}
+                equals_any(std::initializer_list<std::string_view> strings)
+                    : set_(std::make_shared<const detail::string_set>(strings)) {}
+
+                bool operator()(std::string_view s) const {
+                    return set_->contains(s);
+                }
+
+            private:
+                std::shared_ptr<const detail::string_set> set_;
+        };
+
+        /**
+         * Strings containing one of patterns (a pattern_set, or a range of
+         * strings to build one from).
+         */
+        class matches_any {
+            public:
+                template<typename Patterns>
+                    matches_any(const Patterns& patterns) : patterns_(patterns) {}
+                matches_any(std::initializer_list<std::string_view> patterns) : patterns_(patterns) {}
+
+                bool operator()(std::string_view s) const {
+                    return patterns_.contains_any(s);
+                }
+
+            private:
+                pattern_set patterns_;
+        };
+    }
+
+    namespace detail {
+        /**
+         * The map of tag_matches: (element, ids of the patterns it contains).
+         */
+        class match_tagger {
+            public:
+                template<typename Patterns>
+                    match_tagger(const Patterns& patterns) : patterns_(patterns) {}
+                match_tagger(std::initializer_list<std::string_view> patterns) : patterns_(patterns) {}
+
+                template<typename T>
+                    std::tuple<std::decay_t<T>, std::vector<size_t>> operator()(T&& v) const {
+                        std::vector<size_t> ids = patterns_.matches(std::string_view(v));
+                        return std::tuple<std::decay_t<T>, std::vector<size_t>>(std::forward<T>(v), std::move(ids));
+                    }
+
+            private:
+                pattern_set patterns_;
+        };
+    }
+}
@@ -0,0 +1,87 @@
+#include <lazypp.hpp>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <iostream>
+
+/**
+ * Counts every heap allocation of the process, so that pipelines can be
+ * checked to allocate exactly what they are expected to.
+ */
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+	allocations++;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+static int failures = 0;
+
+template<typename Func>
+void expect_allocations(const char* name, size_t expected, Func f) {
+	size_t before = allocations;
+	f();
+	size_t count = allocations - before;
+	std::cout << (count == expected ? "OK   " : "FAIL ") << name << ": " << count << " allocations, expected " << expected << std::endl;
+	if (count != expected)
+		failures++;
+}
+
+int main() {
+	auto square = [](auto&& v) { return v * v; };
+	auto sum = [](auto acum, auto value) { return acum + value; };
+	std::vector<int> values {1, 2, 3, 4, 5, 6, 7, 8};
+	int sink = 0;
+
+	expect_allocations("range map fold", 0, [&]() {
+		sink += lazypp::from::range(1, 10).map(square).fold(0, sum);
+	});
+
+	expect_allocations("stl_container filter each", 0, [&]() {
+		lazypp::from::stl_container(values)
+			.filter([](int v) { return v % 2; })
+			.each([&sink](int v) { sink += v; });
+	});
+
+	expect_allocations("generator take_while take map each", 0, [&]() {
+		int i = 0;
+		lazypp::from::generator([&i]() { return i++; })
+			.take_while([](int v) { return v < 100; })
+			.take(10)
+			.map(square)
+			.each([&sink](int v) { sink += v; });
+	});
+
+	expect_allocations("random set_bits codecs fold", 0, [&]() {
+		uint64_t words[2] = {0xf0f0, 0x1};
+		sink += int(lazypp::from::set_bits(words, 2).encode_delta().decode_delta().fold(size_t(0), sum));
+		sink += int(lazypp::from::random<double>(1).take(100).fold(0.0, sum));
+	});
+
+	expect_allocations("sized to<vector>", 1, [&]() {
+		std::vector<int> squares = lazypp::from::stl_container(values)
+			.map(square)
+			.take(5)
+			.to<std::vector<int>>();
+		sink += squares.back();
+	});
+
+	expect_allocations("grid to<vector>", 1, [&]() {
+		auto cells = lazypp::from::grid(10, 10, lazypp::traversal::tiled, 4)
+			.to<std::vector<std::tuple<size_t, size_t>>>();
+		sink += int(cells.size());
+	});
+
+	std::cout << "(" << sink << ")" << std::endl;
+	return failures ? 1 : 0;
+}
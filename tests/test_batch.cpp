@@ -0,0 +1,72 @@
+#include <lazypp/core.hpp>
+#include <lazypp/algorithms.hpp>
+#include <vector>
+#include <iostream>
+
+int main() {
+	std::vector<float> values {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+	std::vector<size_t> batches;
+	std::vector<const float*> inputs;
+	auto scale = [&batches, &inputs](const float* in, size_t n, float* out) {
+		batches.push_back(n);
+		inputs.push_back(in);
+		for (size_t i = 0; i < n; i++)
+			out[i] = in[i] * 2;
+	};
+
+	std::cout << "Testing map_batch on a contiguous source" << std::endl;
+	std::vector<float> scaled = lazypp::from::stl_container(values)
+		.map_batch(scale, 4)
+		.to<std::vector<float>>();
+	std::cout << "Is 10 == " << scaled.size() << "?" << std::endl;
+	std::cout << "Is 20 == " << scaled[9] << "?" << std::endl;
+	std::cout << "Is 3 == " << batches.size() << "?" << std::endl;
+	std::cout << "Is 2 == " << batches[2] << "?" << std::endl;
+	std::cout << "Is 1 == " << (inputs[0] == values.data() && inputs[1] == values.data() + 4) << "?" << std::endl;
+
+	std::cout << "Testing map_batch on a gathered source" << std::endl;
+	batches.clear();
+	std::cout << "Is 30 == " << lazypp::from::range(0, 6)
+		.map([](int v) { return float(v); })
+		.map_batch(scale, 4)
+		.fold(0.0f, [](float acum, float v) { return acum + v; }) << "?" << std::endl;
+	std::cout << "Is 2 == " << batches.size() << "?" << std::endl;
+
+	std::cout << "Testing map_batch changing the element type" << std::endl;
+	lazypp::from::range(1, 4)
+		.map_batch<double>([](const int* in, size_t n, double* out) {
+				for (size_t i = 0; i < n; i++)
+					out[i] = in[i] / 2.0;
+			})
+		.each([](double v) { std::cout << v << std::endl; });
+
+	std::cout << "Testing chained map_batch" << std::endl;
+	inputs.clear();
+	const float* first_out = nullptr;
+	std::vector<float> chained = lazypp::from::stl_container(values)
+		.map_batch([&first_out](const float* in, size_t n, float* out) {
+				first_out = out;
+				for (size_t i = 0; i < n; i++)
+					out[i] = in[i] + 1;
+			}, 8)
+		.map_batch(scale, 8)
+		.filter([](float v) { return v > 10; })
+		.to<std::vector<float>>();
+	std::cout << "Is 6 == " << chained.size() << "?" << std::endl;
+	std::cout << "Is 22 == " << chained.back() << "?" << std::endl;
+	std::cout << "Is 1 == " << (inputs.back() == first_out) << "?" << std::endl;
+
+	std::cout << "Testing map_batch buffers against a budget" << std::endl;
+	auto budget = std::make_shared<lazypp::memory_budget>();
+	lazypp::from::range(0, 100)
+		.with_budget(budget)
+		.map_batch([](const int* in, size_t n, int* out) {
+				for (size_t i = 0; i < n; i++)
+					out[i] = in[i];
+			}, 16)
+		.take(1)
+		.each([](int) {});
+	std::cout << "Is 128 == " << budget->peak() << "?" << std::endl;
+
+	return 0;
+}
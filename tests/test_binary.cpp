@@ -0,0 +1,75 @@
+#include <lazypp.hpp>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+struct point {
+	float x;
+	float y;
+};
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+	auto sum = [](auto acum, auto value) { return acum + value; };
+	std::string path = "test_binary.tmp";
+
+	std::cout << "Testing raw round trip" << std::endl;
+	lazypp::from::range(1, 6)
+		.map([](int v) { return v * 1.5; })
+		.write_binary(path);
+	lazypp::from::binary<double>(path)
+		.each(show);
+
+	std::cout << "Testing varint round trip" << std::endl;
+	std::cout << "Is " << lazypp::from::range(-500, 500).fold(0, sum) << " == ";
+	lazypp::from::range(-500, 500)
+		.write_binary(path, lazypp::binary_encoding::varint);
+	std::cout << lazypp::from::binary<int>(path).fold(0, sum) << "?" << std::endl;
+
+	std::cout << "Testing delta varint round trip" << std::endl;
+	size_t written = lazypp::from::range(uint64_t(1000000), uint64_t(1100000))
+		.filter([](uint64_t v) { return v % 7 == 0; })
+		.write_binary(path, lazypp::binary_encoding::delta_varint);
+	std::cout << "Is " << written << " == " << lazypp::from::binary<uint64_t>(path).fold(size_t(0), [](size_t acum, uint64_t) { return acum + 1; }) << "?" << std::endl;
+	lazypp::from::binary<uint64_t>(path)
+		.take(3)
+		.each(show);
+
+	std::cout << "Testing delta varint across the whole range" << std::endl;
+	std::vector<int> extremes = {0, std::numeric_limits<int>::max(), std::numeric_limits<int>::min(), -1, std::numeric_limits<int>::max(), 7};
+	lazypp::from::stl_container(extremes)
+		.write_binary(path, lazypp::binary_encoding::delta_varint);
+	lazypp::from::binary<int>(path)
+		.each(show);
+	std::vector<uint8_t> falling = {200, 3, 255, 0, 1};
+	lazypp::from::stl_container(falling)
+		.write_binary(path, lazypp::binary_encoding::delta_varint);
+	lazypp::from::binary<uint8_t>(path)
+		.each([](uint8_t v) { std::cout << int(v) << std::endl; });
+
+	std::cout << "Testing varint size" << std::endl;
+	auto varints = lazypp::from::binary<uint8_t>(path).iterator();
+	std::cout << "Is 5 == " << varints.size() << "?" << std::endl;
+	varints.next();
+	varints.next();
+	std::cout << "Is 3 == " << varints.size() << "?" << std::endl;
+
+	std::cout << "Testing struct round trip" << std::endl;
+	lazypp::from::range(0, 3)
+		.map([](int i) { return point{float(i), float(i * i)}; })
+		.write_binary(path);
+	lazypp::from::binary<point>(path)
+		.each([](const point& p) { std::cout << p.x << "," << p.y << std::endl; });
+
+	std::cout << "Testing element size mismatch" << std::endl;
+	try {
+		lazypp::from::binary<float>(path);
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	std::remove(path.c_str());
+	return 0;
+}
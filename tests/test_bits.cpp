@@ -0,0 +1,46 @@
+#include <lazypp.hpp>
+#include <bitset>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+
+	std::cout << "Testing set bits from words" << std::endl;
+	std::vector<uint64_t> words {0x11, 0, 0x8000000000000000ull};
+	lazypp::from::set_bits(words)
+		.each(show);
+
+	std::cout << "Testing set bits from bitset" << std::endl;
+	std::bitset<70> bitset;
+	bitset.set(3).set(64).set(69);
+	lazypp::from::set_bits(bitset)
+		.each(show);
+
+	std::cout << "Testing set bits from a sparse bitset" << std::endl;
+	std::bitset<100000> sparse;
+	for (size_t i = 7; i < sparse.size(); i += 9973)
+		sparse.set(i);
+	sparse.set(sparse.size() - 1);
+	std::vector<size_t> expected;
+	for (size_t i = 0; i < sparse.size(); i++)
+		if (sparse[i])
+			expected.push_back(i);
+	std::cout << "Is 1 == " << (lazypp::from::set_bits(sparse).to<std::vector<size_t>>() == expected) << "?" << std::endl;
+	std::cout << "Is 0 == " << lazypp::from::set_bits(std::bitset<100>()).to<std::vector<size_t>>().size() << "?" << std::endl;
+
+	std::cout << "Testing set bits from vector<bool>" << std::endl;
+	std::vector<bool> flags(130);
+	flags[1] = flags[65] = flags[129] = true;
+	lazypp::from::set_bits(flags)
+		.each(show);
+
+	std::cout << "Testing conversion to bitmap" << std::endl;
+	std::vector<uint64_t> bitmap = lazypp::from::range(0, 200)
+		.filter([](int v) { return v % 50 == 0; })
+		.to_bitmap(128);
+	lazypp::from::set_bits(bitmap)
+		.each(show);
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include <lazypp.hpp>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+	auto sum = [](auto acum, auto value) { return acum + value; };
+	std::vector<uint32_t> ids;
+	for (uint32_t i = 0; i < 1000; i++)
+		ids.push_back(i * 37 + i % 5);
+	uint64_t expected = lazypp::from::stl_container(ids).fold(uint64_t(0), sum);
+
+	std::cout << "Testing delta" << std::endl;
+	lazypp::from::stl_container(ids)
+		.encode_delta()
+		.take(4)
+		.each(show);
+	std::cout << "Is " << expected << " == " << lazypp::from::stl_container(ids)
+		.encode_delta()
+		.decode_delta()
+		.fold(uint64_t(0), sum) << "?" << std::endl;
+
+	std::cout << "Testing delta varint" << std::endl;
+	std::vector<uint8_t> bytes = lazypp::from::stl_container(ids)
+		.encode_delta()
+		.encode_varint()
+		.to<std::vector<uint8_t>>();
+	std::cout << "Is 1000 == " << bytes.size() << "?" << std::endl;
+	std::cout << "Is " << expected << " == " << lazypp::from::varint<uint32_t>(bytes)
+		.decode_delta()
+		.fold(uint64_t(0), sum) << "?" << std::endl;
+	std::cout << "Is " << expected << " == " << lazypp::from::stl_container(bytes)
+		.decode_varint<uint32_t>()
+		.decode_delta()
+		.fold(uint64_t(0), sum) << "?" << std::endl;
+
+	std::cout << "Testing signed varint" << std::endl;
+	lazypp::from::range(-2, 3)
+		.encode_varint()
+		.decode_varint<int>()
+		.each(show);
+
+	std::cout << "Testing bitpack" << std::endl;
+	for (unsigned bits : {0u, 1u, 6u, 17u, 32u, 64u}) {
+		std::vector<uint64_t> words = lazypp::from::stl_container(ids)
+			.bitpack(bits)
+			.to<std::vector<uint64_t>>();
+		uint64_t total = lazypp::from::bitpacked<uint64_t>(words, ids.size(), bits)
+			.fold(uint64_t(0), sum);
+		uint64_t masked = lazypp::from::stl_container(ids)
+			.map([bits](uint32_t v) { return bits >= 64 ? uint64_t(v) : uint64_t(v) & ((uint64_t(1) << bits) - 1); })
+			.fold(uint64_t(0), sum);
+		std::cout << bits << " bits: " << words.size() << " words, is " << masked << " == " << total << "?" << std::endl;
+	}
+	std::cout << "Is 0 == " << lazypp::from::generator([]() { return uint64_t(1); }).bitpack(0)
+		.fold(size_t(0), [](size_t acum, uint64_t) { return acum + 1; }) << "?" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include <lazypp.hpp>
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template<typename A, typename B, typename = void>
+struct can_and : std::false_type {};
+
+template<typename A, typename B>
+struct can_and<A, B, std::void_t<decltype(std::declval<A>() && std::declval<B>())>> : std::true_type {};
+
+// only zone map predicates combine with &&, other where:: types don't pick it up by ADL
+static_assert(can_and<lazypp::where::less<int>, lazypp::where::between<int>>::value);
+static_assert(!can_and<lazypp::where::less<int>, int>::value);
+static_assert(!can_and<lazypp::where::contains, lazypp::where::contains>::value);
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+	std::string path = "test_columnar.tmp";
+
+	// timestamps, sorted so each block covers a narrow range
+	size_t written = lazypp::from::range(int64_t(0), int64_t(100000))
+		.map([](int64_t i) { return 1600000000 + i * 10; })
+		.write_columnar(path, 1000);
+	std::cout << "Is 100000 == " << written << "?" << std::endl;
+
+	std::cout << "Testing full scan" << std::endl;
+	std::cout << "Is 100000 == " << lazypp::from::columnar<int64_t>(path).fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing predicate in source" << std::endl;
+	lazypp::from::columnar<int64_t>(path, lazypp::where::between(1600500000, 1600500030))
+		.each(show);
+
+	std::cout << "Testing predicate pushed down from filter" << std::endl;
+	std::cout << "Is 9 == " << lazypp::from::columnar<int64_t>(path)
+		.filter(lazypp::where::greater(int64_t(1600999900)) && lazypp::where::less(int64_t(1601000000)))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing lambda filter on columnar" << std::endl;
+	std::cout << "Is 50000 == " << lazypp::from::columnar<int64_t>(path)
+		.filter([](int64_t v) { return v % 20 == 0; })
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing unsorted values" << std::endl;
+	lazypp::from::range(0, 20)
+		.map([](int i) { return double((i * 7) % 20); })
+		.write_columnar(path, 4);
+	lazypp::from::columnar<double>(path)
+		.filter(lazypp::where::equal(13.0))
+		.each(show);
+
+	std::cout << "Testing NaN in a block" << std::endl;
+	std::vector<double> with_nan = {1, std::nan(""), 2, 3, 4, 5, 6, 7};
+	lazypp::from::stl_container(with_nan)
+		.write_columnar(path, 4);
+	lazypp::from::columnar<double>(path)
+		.filter(lazypp::where::greater(0.0))
+		.each(show);
+	std::cout << "Is 8 == " << lazypp::from::columnar<double>(path).fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing block header padding" << std::endl;
+	lazypp::from::range(0, 3)
+		.map([](int i) { return int16_t(i); })
+		.write_columnar(path);
+	lazypp::mapped_file small(path);
+	// 16 byte file header, then count (8 bytes), min and max (2 bytes each) and 4 of padding
+	std::cout << "Is 4 == " << std::count(small.view().begin() + 16 + 12, small.view().begin() + 16 + 16, '\0') << "?" << std::endl;
+
+	std::remove(path.c_str());
+	return 0;
+}
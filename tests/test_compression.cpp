@@ -0,0 +1,56 @@
+#define LAZYPP_WITH_ZLIB
+#include <lazypp.hpp>
+#include <string>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+	std::string fixture = std::string(FIXTURES_DIR) + "/log.txt.gz";
+
+	std::cout << "Testing gzip blocks" << std::endl;
+	std::cout << "Is 106512 == " << lazypp::from::gzip_file(fixture)
+		.fold(size_t(0), [](size_t acum, std::string_view block) { return acum + block.size(); }) << "?" << std::endl;
+
+	std::cout << "Testing gzip lines over small blocks" << std::endl;
+	std::cout << "Is 3000 == " << lazypp::from::lines(lazypp::from::gzip_file(fixture, 1000))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing gzip csv" << std::endl;
+	std::cout << "Is 604 == " << lazypp::from::csv<2>(lazypp::from::lines(lazypp::from::gzip_file(fixture, 4096)))
+		.filter([](auto&& row) { return row[1] == "error"; })
+		.fold(size_t(0), count) << "?" << std::endl;
+	std::cout << "Is 4498500 == " << lazypp::from::csv<1>(lazypp::from::lines(lazypp::from::gzip_file(fixture)))
+		.map([](auto&& row) { return std::stoul(std::string(row[0])); })
+		.fold(size_t(0), [](size_t acum, size_t v) { return acum + v; }) << "?" << std::endl;
+
+	std::cout << "Testing concatenated gzip members" << std::endl;
+	lazypp::mapped_file file(fixture);
+	std::string twice = std::string(file.view()) + std::string(file.view());
+	std::cout << "Is 6000 == " << lazypp::from::lines(lazypp::from::gzip(twice, 777))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing corrupted gzip" << std::endl;
+	std::string corrupted = std::string(file.view()).substr(0, 5000);
+	try {
+		lazypp::from::gzip(corrupted).each([](auto&&) {});
+		std::cout << "no error" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	std::cout << "Testing lines over an empty chunk" << std::endl;
+	std::vector<std::string_view> chunks = {"a\nb", "", "c\nd\n"};
+	std::string joined;
+	lazypp::from::lines(lazypp::from::stl_container(chunks))
+		.each([&joined](std::string_view line) { joined += std::string(line) + ","; });
+	std::cout << "Is a,bc,d, == " << joined << "?" << std::endl;
+
+	std::cout << "Testing gzip stopped early" << std::endl;
+	lazypp::from::lines(lazypp::from::gzip_file(fixture, 1024))
+		.take(2)
+		.each([](std::string_view line) { std::cout << line << std::endl; });
+
+	return 0;
+}
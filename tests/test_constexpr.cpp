@@ -0,0 +1,52 @@
+#include <lazypp/core.hpp>
+#include <array>
+#include <iostream>
+
+/**
+ * Everything here is evaluated by the compiler: the static_asserts fail to
+ * build if any stage stops being usable in constant expressions.
+ */
+constexpr uint8_t reverse_bits(int v) {
+	uint8_t r = 0;
+	for (int i = 0; i < 8; i++)
+		r |= uint8_t(((v >> i) & 1) << (7 - i));
+	return r;
+}
+
+constexpr auto reversed = lazypp::from::range(0, 256).map(reverse_bits).to_array<256>();
+
+static_assert(reversed[0] == 0x00);
+static_assert(reversed[1] == 0x80);
+static_assert(reversed[0x0f] == 0xf0);
+static_assert(reversed[255] == 0xff);
+
+constexpr int sum_even_squares = lazypp::from::range(1, 100)
+	.filter([](int v) { return v % 2 == 0; })
+	.map([](int v) { return v * v; })
+	.take_while([](int v) { return v < 1000; })
+	.fold(0, [](int acum, int v) { return acum + v; });
+
+static_assert(sum_even_squares == 4 + 16 + 36 + 64 + 100 + 144 + 196 + 256 + 324 + 400 + 484 + 576 + 676 + 784 + 900);
+
+constexpr auto staged = lazypp::from::range(0, 1000)
+	.staged(lazypp::stage::filter([](int v) { return v % 3 == 0; }),
+		lazypp::stage::map([](int v) { return v + 1; }),
+		lazypp::stage::take(4))
+	.to_array<6>();
+
+static_assert(staged[0] == 1 && staged[3] == 10 && staged[4] == 0 && staged[5] == 0);
+
+constexpr std::array<int, 5> primes = {2, 3, 5, 7, 11};
+
+static_assert(lazypp::from::stl_container(primes).take(3).fold(0, [](int acum, int v) { return acum + v; }) == 10);
+
+int main() {
+	std::cout << "Is 128 == " << int(reversed[1]) << "?" << std::endl;
+	std::cout << "Is 4960 == " << sum_even_squares << "?" << std::endl;
+	std::cout << "Is 1 4 7 10 0 0 == ";
+	for (int v : staged)
+		std::cout << v << " ";
+	std::cout << "?" << std::endl;
+
+	return 0;
+}
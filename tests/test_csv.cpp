@@ -0,0 +1,65 @@
+#include <lazypp.hpp>
+#include <array>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& row) {
+		for (auto&& field : row)
+			std::cout << "[" << field << "]";
+		std::cout << std::endl;
+	};
+
+	std::string text =
+		"id,name,comment,score\n"
+		"1,alice,\"likes, commas\",10\n"
+		"2,bob,\"multi\nline\",20\r\n"
+		"\n"
+		"3,\"carol \"\"c\"\"\",,30\n"
+		"4,dave";
+
+	std::cout << "Testing csv" << std::endl;
+	lazypp::from::csv<4>(text)
+		.each(show);
+
+	std::cout << "Testing csv selected columns" << std::endl;
+	lazypp::from::csv_columns<2>(text, {3, 1})
+		.each(show);
+
+	std::cout << "Testing tsv over blocks" << std::endl;
+	std::string tsv;
+	for (int i = 0; i < 40; i++)
+		tsv += std::to_string(i) + "\t\"quoted\tfield\"\t" + std::to_string(i * i) + "\n";
+	std::cout << "Is 20540 == " << lazypp::from::csv_columns<1>(tsv, {2}, '\t')
+		.map([](auto&& row) { return std::stoi(std::string(row[0])); })
+		.fold(0, [](int acum, int v) { return acum + v; }) << "?" << std::endl;
+
+	std::cout << "Testing csv last row without a newline" << std::endl;
+	auto rows = [](std::string_view csv) {
+		return lazypp::from::csv<3>(csv).to<std::vector<std::array<std::string_view, 3>>>();
+	};
+	auto trailing = rows("x,y,z\nfoo,bar,");
+	std::cout << "Is 2 == " << trailing.size() << "?" << std::endl;
+	std::cout << "Is 1 == " << (trailing.size() == 2 && trailing[1][0] == "foo" && trailing[1][1] == "bar" && trailing[1][2].empty()) << "?" << std::endl;
+	auto quoted = rows("x,y,z\nfoo,bar,\"q, \nr\"");
+	std::cout << "Is 2 == " << quoted.size() << "?" << std::endl;
+	std::cout << "Is 1 == " << (quoted.size() == 2 && quoted[1][2] == "q, \nr") << "?" << std::endl;
+	std::cout << "Is 1 == " << rows(",").size() << "?" << std::endl;
+	std::cout << "Is 0 == " << rows("").size() << "?" << std::endl;
+	std::cout << "Is 1 == " << rows("a,b\n").size() << "?" << std::endl;
+
+	std::cout << "Testing csv from mapped file" << std::endl;
+	std::string path = "test_csv.tmp";
+	std::ofstream(path) << "a,b\nc,d\n";
+	{
+		lazypp::mapped_file file(path);
+		lazypp::from::csv<2>(file)
+			.each(show);
+	}
+	std::remove(path.c_str());
+
+	return 0;
+}
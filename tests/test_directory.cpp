@@ -0,0 +1,64 @@
+#include <lazypp.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+int main() {
+	fs::path root = fs::temp_directory_path() / "lazypp_test_directory";
+	fs::remove_all(root);
+	for (auto&& dir : {"a/x", "a/y", "b", "c/z/w"})
+		fs::create_directories(root / dir);
+	for (auto&& file : {"a/1.txt", "a/x/2.txt", "b/3.txt", "c/z/w/4.txt", "5.txt"})
+		std::ofstream(root / file) << file;
+
+	auto relative = [&root](const fs::path& p) { return p.lexically_relative(root).generic_string(); };
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+
+	std::cout << "Testing directory" << std::endl;
+	std::cout << "Is 4 == " << lazypp::from::directory(root).fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing recursive directory" << std::endl;
+	std::cout << "Is 12 == " << lazypp::from::directory(root, true).fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing parallel directory sorted" << std::endl;
+	lazypp::from::parallel_directory(root, lazypp::walk_order::sorted, 4)
+		.each([&](const lazypp::walk_entry& e) {
+			std::cout << relative(e.path) << (e.is_directory() ? "/" : "") << std::endl;
+		});
+
+	std::cout << "Testing parallel directory unordered" << std::endl;
+	std::cout << "Is 5 == " << lazypp::from::parallel_directory(root)
+		.filter([](const lazypp::walk_entry& e) { return e.is_regular_file(); })
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing parallel directory stopped early" << std::endl;
+	lazypp::from::parallel_directory(root, lazypp::walk_order::unordered, 2)
+		.take(1)
+		.each([](auto&&) { std::cout << "one" << std::endl; });
+
+	std::cout << "Testing parallel directory over more directories than it lists ahead" << std::endl;
+	fs::path wide = root / "wide";
+	for (size_t i = 0; i < lazypp::detail::parallel_walker::max_ahead + 500; i++)
+		fs::create_directories(wide / std::to_string(i % 40) / std::to_string(i));
+	std::vector<std::string> sequential;
+	for (auto it = fs::recursive_directory_iterator(wide); it != fs::recursive_directory_iterator(); ++it)
+		sequential.push_back(relative(it->path()));
+	std::sort(sequential.begin(), sequential.end());
+	std::vector<std::string> sorted = lazypp::from::parallel_directory(wide, lazypp::walk_order::sorted, 4)
+		.map([&](const lazypp::walk_entry& e) { return relative(e.path); })
+		.to<std::vector<std::string>>();
+	std::cout << "Is " << sequential.size() << " == " << sorted.size() << "?" << std::endl;
+	std::cout << "Is 1 == " << std::is_sorted(sorted.begin(), sorted.end(), [](const std::string& a, const std::string& b) { return fs::path(a) < fs::path(b); }) << "?" << std::endl;
+	std::sort(sorted.begin(), sorted.end());
+	std::cout << "Is 1 == " << (sorted == sequential) << "?" << std::endl;
+	std::cout << "Is " << sequential.size() << " == " << lazypp::from::parallel_directory(wide, lazypp::walk_order::unordered, 4)
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	fs::remove_all(root);
+	return 0;
+}
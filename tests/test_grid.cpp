@@ -0,0 +1,39 @@
+#include <lazypp.hpp>
+#include <tuple>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& v) {
+		std::cout << std::get<0>(v) << "," << std::get<1>(v) << std::endl;
+	};
+
+	std::cout << "Testing grid row major" << std::endl;
+	lazypp::from::grid(3, 2)
+		.each(show);
+
+	std::cout << "Testing grid column major" << std::endl;
+	lazypp::from::grid(3, 2, lazypp::traversal::column_major)
+		.each(show);
+
+	std::cout << "Testing grid tiled" << std::endl;
+	lazypp::from::grid(3, 3, lazypp::traversal::tiled, 2)
+		.each(show);
+
+	std::cout << "Testing matrix view" << std::endl;
+	int data[2][4] = {{1, 2, 3, 0}, {4, 5, 6, 0}};
+	lazypp::from::matrix_view(&data[0][0], 2, 3, 4, lazypp::traversal::column_major)
+		.each([](auto&& v) {
+			std::cout << std::get<0>(v) << "," << std::get<1>(v) << " = " << std::get<2>(v) << std::endl;
+		});
+
+	std::cout << "Testing tiles" << std::endl;
+	int total = lazypp::from::tiles(3, 2, 2, 2)
+		.map([&data](lazypp::grid_region region) {
+			return lazypp::from::matrix_view(&data[0][0], 4, region)
+				.fold(0, [](int acum, auto&& v) { return acum + std::get<2>(v); });
+		})
+		.fold(0, [](int acum, int value) { return acum + value; });
+	std::cout << "Is 21 == " << total << "?" << std::endl;
+
+	return 0;
+}
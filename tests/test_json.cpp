@@ -0,0 +1,35 @@
+#include <lazypp.hpp>
+#include <string>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+
+	std::string text =
+		"{\"level\": \"info\", \"msg\": \"started\", \"ms\": 12}\n"
+		"{\"msg\": \"a \\\"quoted\\\" {brace}\", \"ctx\": {\"level\": \"nested\"}, \"level\": \"error\", \"ms\": 340}\r\n"
+		"\n"
+		"{\"level\": \"error\", \"tags\": [1, {\"a\": \"]\"}], \"ms\": 7.5, \"ok\": false}\n";
+
+	std::cout << "Testing lines" << std::endl;
+	lazypp::from::lines("one\ntwo\r\n\nthree")
+		.each([](std::string_view line) { std::cout << "[" << line << "]" << std::endl; });
+
+	std::cout << "Testing json lines filter on one field" << std::endl;
+	lazypp::from::json_lines(text)
+		.filter([](const lazypp::json_value& doc) { return doc["level"].as_string() == "error"; })
+		.map([](const lazypp::json_value& doc) { return doc["ms"].raw(); })
+		.each(show);
+
+	std::cout << "Testing json value conversions" << std::endl;
+	lazypp::from::json_lines(text)
+		.each([](const lazypp::json_value& doc) {
+			std::cout << doc["ms"].as_int64().value_or(-1) << " "
+				<< doc["ms"].as_double().value_or(-1) << " "
+				<< doc["ctx"]["level"].as_string() << " "
+				<< doc["ok"].as_bool().value_or(true) << " "
+				<< bool(doc["missing"]) << std::endl;
+		});
+
+	return 0;
+}
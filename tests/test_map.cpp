@@ -49,5 +49,36 @@ int main() {
 		.take(10)
 		.fold(0, [](auto acum, auto value) { return acum + value;}) << "?" << std::endl;
 
+	std::cout << "Testing staged pipeline" << std::endl;
+	size_t pulled = 0;
+	std::vector<size_t> staged = lazypp::from::generator([&pulled]() { return pulled++; })
+		.staged(lazypp::stage::filter([](size_t v) { return v % 2 == 0;}),
+			lazypp::stage::take(5),
+			lazypp::stage::map(square))
+		.to<std::vector<size_t>>();
+	std::cout << "Is 120 == " << staged[0] + staged[1] + staged[2] + staged[3] + staged[4] << "?" << std::endl;
+	std::cout << "Is 9 == " << pulled << "?" << std::endl;
+	std::cout << "Is 45 == " << lazypp::from::range(1, 1000)
+		.staged(lazypp::stage::take_while([](auto&& v) { return v < 10; }))
+		.fold(0, [](auto acum, auto value) { return acum + value;}) << "?" << std::endl;
+	std::cout << "Is 0 == " << lazypp::from::range(1, 1000)
+		.staged(lazypp::stage::take(0))
+		.fold(0, [](auto acum, auto value) { return acum + value;}) << "?" << std::endl;
+
+	std::cout << "Testing terminals stop pulling once done" << std::endl;
+	pulled = 0;
+	std::vector<size_t> chained = lazypp::from::generator([&pulled]() { return pulled++; })
+		.filter([](size_t v) { return v % 2 == 0;})
+		.take(5)
+		.map(square)
+		.to<std::vector<size_t>>();
+	std::cout << "Is 5 == " << chained.size() << "?" << std::endl;
+	std::cout << "Is 9 == " << pulled << "?" << std::endl;
+	pulled = 0;
+	std::cout << "Is 45 == " << lazypp::from::generator([&pulled]() { return pulled++; })
+		.take_while([](auto&& v) { return v < 10; })
+		.fold(size_t(0), [](auto acum, auto value) { return acum + value;}) << "?" << std::endl;
+	std::cout << "Is 11 == " << pulled << "?" << std::endl;
+
 	return 0;
 }
@@ -0,0 +1,59 @@
+#define LAZYPP_WITH_ZLIB
+#include <lazypp.hpp>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+	std::string fixture = std::string(FIXTURES_DIR) + "/log.txt.gz";
+	std::vector<int> table(1000, 1);
+
+	std::cout << "Testing prefetch accounting" << std::endl;
+	auto budget = std::make_shared<lazypp::memory_budget>();
+	lazypp::from::range(0, 1000)
+		.with_budget(budget)
+		.gather(table, 32)
+		.each([](int) {});
+	std::cout << "Is " << 32 * sizeof(std::optional<int>) << " == " << budget->peak() << "?" << std::endl;
+	std::cout << "Is 0 == " << budget->used() << "?" << std::endl;
+
+	std::cout << "Testing copies and moves of a started prefetch" << std::endl;
+	auto started = lazypp::from::range(0, 1000)
+		.with_budget(budget)
+		.gather(table, 32)
+		.iterator();
+	started.next();
+	size_t used = budget->used();
+	{
+		// the copy holds its own ring
+		auto copy = started;
+		std::cout << "Is " << 2 * used << " == " << budget->used() << "?" << std::endl;
+		copy.next();
+		std::cout << "Is " << 2 * used << " == " << budget->used() << "?" << std::endl;
+		// a move takes the ring and its bytes with it
+		auto moved = std::move(copy);
+		moved.next();
+		std::cout << "Is " << 2 * used << " == " << budget->used() << "?" << std::endl;
+	}
+	std::cout << "Is " << used << " == " << budget->used() << "?" << std::endl;
+
+	std::cout << "Testing decompression accounting" << std::endl;
+	auto lines = lazypp::from::lines(lazypp::from::gzip_file(fixture, 4096).with_budget());
+	std::cout << "Is 3000 == " << lines.fold(size_t(0), count) << "?" << std::endl;
+	std::cout << "Peak above two blocks: " << (lines.budget()->peak() > 2 * 4096) << std::endl;
+
+	std::cout << "Testing budget exceeded" << std::endl;
+	try {
+		lazypp::from::lines(lazypp::from::gzip_file(fixture, 1 << 20).with_budget(1 << 20))
+			.each([](std::string_view) {});
+		std::cout << "no error" << std::endl;
+	}
+	catch (const lazypp::memory_budget_exceeded& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	std::cout << "Testing pipelines without budget" << std::endl;
+	std::cout << "Is 1 == " << (lazypp::from::range(0, 10).gather(table).budget() == nullptr) << "?" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,71 @@
+#include <lazypp/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <iostream>
+
+/**
+ * Counts its deep copies, the pipelines below must not make any.
+ */
+struct buffer {
+	static int copies;
+
+	std::string data;
+
+	buffer(std::string d) : data(std::move(d)) {}
+	buffer(const buffer& b) : data(b.data) { copies++; }
+	buffer(buffer&&) = default;
+	buffer& operator=(const buffer& b) { data = b.data; copies++; return *this; }
+	buffer& operator=(buffer&&) = default;
+};
+
+int buffer::copies = 0;
+
+int main() {
+	std::cout << "Testing unique_ptr elements" << std::endl;
+	int n = 0;
+	std::vector<std::unique_ptr<int>> owned = lazypp::from::generator([&n]() { return std::make_unique<int>(n++); })
+		.map([](std::unique_ptr<int> p) { *p *= 3; return p; })
+		.filter([](const std::unique_ptr<int>& p) { return *p % 2 == 0; })
+		.take_while([](const std::unique_ptr<int>& p) { return *p < 30; })
+		.take(4)
+		.to<std::vector<std::unique_ptr<int>>>();
+	std::cout << "Is 4 == " << owned.size() << "?" << std::endl;
+	std::cout << "Is 18 == " << *owned[3] << "?" << std::endl;
+
+	std::cout << "Is 36 == " << lazypp::from::stl_iterator(std::make_move_iterator(owned.begin()), std::make_move_iterator(owned.end()))
+		.staged(lazypp::stage::filter([](const std::unique_ptr<int>& p) { return *p > 0; }),
+			lazypp::stage::map([](std::unique_ptr<int> p) { return std::move(p); }))
+		.fold(0, [](int acum, std::unique_ptr<int> p) { return acum + *p; }) << "?" << std::endl;
+
+	std::cout << "Testing deep copies" << std::endl;
+	std::vector<buffer> buffers;
+	for (int i = 0; i < 10; i++)
+		buffers.emplace_back(std::string(1000, char('a' + i)));
+	buffer::copies = 0;
+	std::vector<buffer> kept = lazypp::from::stl_iterator(std::make_move_iterator(buffers.begin()), std::make_move_iterator(buffers.end()))
+		.map([](buffer b) { b.data += '!'; return b; })
+		.filter([](const buffer& b) { return b.data[0] != 'c'; })
+		.take(5)
+		.to<std::vector<buffer>>();
+	std::cout << "Is 5 == " << kept.size() << "?" << std::endl;
+	std::string joined = lazypp::from::stl_iterator(std::make_move_iterator(kept.begin()), std::make_move_iterator(kept.end()))
+		.fold(std::string(), [](std::string acum, buffer b) { return std::move(acum) + b.data.substr(0, 1); });
+	std::cout << "Is abdef == " << joined << "?" << std::endl;
+	std::cout << "Is 0 == " << buffer::copies << "?" << std::endl;
+
+	std::cout << "Testing moved pipelines" << std::endl;
+	auto pipeline = lazypp::from::range(0, 10)
+		.map([b = buffer(std::string(1000, 'x'))](int v) { return v + int(b.data.size()); })
+		.filter([b = buffer(std::string(10, 'y'))](int v) { return v % int(b.data.size()) != 0; })
+		.take_while([b = buffer("z")](int v) { return v < 1009 + int(b.data.size()); })
+		.take(5);
+	buffer::copies = 0;
+	auto moved = std::move(pipeline);
+	auto iterator = std::move(moved.iterator());
+	std::cout << "Is 1001 == " << iterator.next().value_or(0) << "?" << std::endl;
+	std::cout << "Is 0 == " << buffer::copies << "?" << std::endl;
+
+	return buffer::copies == 0 ? 0 : 1;
+}
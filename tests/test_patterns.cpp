@@ -0,0 +1,79 @@
+#include <lazypp.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <iostream>
+
+int main() {
+	std::string text =
+		"GET /index.html 200\n"
+		"POST /api/login 401\n"
+		"GET /admin/users 403\n"
+		"GET /static/app.js 304\n"
+		"DELETE /api/session 500";
+
+	std::cout << "Testing match_any" << std::endl;
+	lazypp::from::lines(text)
+		.match_any({" 401", " 403", " 500"})
+		.each([](std::string_view line) { std::cout << line << std::endl; });
+
+	std::cout << "Testing tag_matches" << std::endl;
+	lazypp::pattern_set routes {"/api/", "/admin/", "login", "/", "users"};
+	lazypp::from::lines(text)
+		.tag_matches(routes)
+		.each([](const std::tuple<std::string_view, std::vector<size_t>>& t) {
+				std::cout << std::get<0>(t) << ":";
+				for (size_t id : std::get<1>(t))
+					std::cout << " " << id;
+				std::cout << std::endl;
+			});
+
+	std::cout << "Testing overlapping patterns" << std::endl;
+	lazypp::pattern_set words(std::vector<std::string>{"he", "she", "his", "hers"});
+	std::cout << "Is 4 == " << words.size() << "?" << std::endl;
+	words.each_match("ushers", [](size_t id, size_t end) {
+			std::cout << id << " ends at " << end << std::endl;
+			return true;
+		});
+	std::cout << "Is 1 == " << words.contains_any("ahishers") << "?" << std::endl;
+	std::cout << "Is 0 == " << words.contains_any("hs eh") << "?" << std::endl;
+	std::cout << "Is 1 == " << lazypp::pattern_set({"", "x"}).contains_any("abc") << "?" << std::endl;
+
+	// random patterns and texts over a small alphabet, against std::string::find
+	std::vector<std::string> patterns;
+	std::vector<std::string> texts;
+	std::vector<char> letters = lazypp::from::random<int>(5, std::uniform_int_distribution<int>(0, 4))
+		.map([](int v) { return "abcd\xff"[v]; })
+		.take(30000)
+		.to<std::vector<char>>();
+	size_t pos = 0;
+	auto next_letter = [&letters, &pos]() { return letters[pos++]; };
+	for (size_t k = 0; k < 300; k++) {
+		std::string p;
+		for (size_t i = 0; i < 1 + k % 7; i++)
+			p += next_letter();
+		patterns.push_back(p);
+	}
+	for (size_t k = 0; k < 200; k++) {
+		std::string t;
+		for (size_t i = 0; i < k; i++)
+			t += next_letter();
+		texts.push_back(t);
+	}
+	lazypp::pattern_set many(patterns);
+	size_t mismatches = 0;
+	for (const std::string& t : texts) {
+		std::vector<size_t> expected;
+		for (size_t id = 0; id < patterns.size(); id++)
+			if (t.find(patterns[id]) != std::string::npos)
+				expected.push_back(id);
+		mismatches += many.matches(t) != expected;
+		mismatches += many.contains_any(t) != !expected.empty();
+	}
+	std::cout << "Is 0 == " << mismatches << "?" << std::endl;
+	std::cout << "Is 1 == " << (lazypp::from::stl_container(texts).match_any(many).fold(size_t(0), [](size_t acum, auto&&) { return acum + 1; })
+		== lazypp::from::stl_container(texts).tag_matches(many).filter([](auto&& t) { return !std::get<1>(t).empty(); })
+			.fold(size_t(0), [](size_t acum, auto&&) { return acum + 1; })) << "?" << std::endl;
+
+	return mismatches != 0;
+}
@@ -0,0 +1,33 @@
+#include <lazypp.hpp>
+#include <vector>
+#include <iostream>
+
+struct node {
+	int value;
+	node* next;
+};
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+	std::vector<int> table {10, 11, 12, 13, 14, 15, 16, 17};
+	std::vector<size_t> ids {7, 0, 3, 3, 5};
+
+	std::cout << "Testing gather" << std::endl;
+	lazypp::from::stl_container(ids)
+		.gather(table, 2)
+		.each(show);
+
+	std::cout << "Testing prefetch ahead of a short source" << std::endl;
+	lazypp::from::stl_container(ids)
+		.prefetch_ahead(16, [&table](size_t id) { return &table[id]; })
+		.map([&table](size_t id) { return table[id]; })
+		.each(show);
+
+	std::cout << "Testing linked" << std::endl;
+	node nodes[3] = {{1, &nodes[1]}, {2, &nodes[2]}, {3, nullptr}};
+	lazypp::from::linked(&nodes[0], [](node* n) { return n->next; })
+		.map([](node* n) { return n->value; })
+		.each(show);
+
+	return 0;
+}
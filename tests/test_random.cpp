@@ -0,0 +1,60 @@
+#include <lazypp.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto show = [](auto&& v) { std::cout << v << std::endl; };
+	auto sum = [](auto acum, auto value) { return acum + value; };
+
+	std::cout << "Testing uniform doubles" << std::endl;
+	lazypp::from::random<double>(42)
+		.take(5)
+		.each(show);
+
+	std::cout << "Testing bounded uniform integers" << std::endl;
+	lazypp::from::random<int>(42, std::uniform_int_distribution<int>(1, 6))
+		.take(10)
+		.each(show);
+
+	std::cout << "Testing stateless uniform integers" << std::endl;
+	std::vector<int> dice = lazypp::from::random<int>(42, lazypp::distributions::uniform<int>(-3, 3))
+		.take(1000)
+		.to<std::vector<int>>();
+	std::vector<size_t> faces(7);
+	bool in_range = true;
+	for (int v : dice) {
+		in_range = in_range && v >= -3 && v <= 3;
+		if (in_range)
+			faces[v + 3]++;
+	}
+	std::cout << "Is 1 == " << in_range << "?" << std::endl;
+	std::cout << "Is 1 == " << (*std::min_element(faces.begin(), faces.end()) > 100) << "?" << std::endl;
+	uint64_t full = lazypp::from::random<uint64_t>(1, lazypp::distributions::uniform<uint64_t>(0, ~uint64_t(0)))
+		.take(2)
+		.fold(uint64_t(0), [](uint64_t acum, uint64_t v) { return acum ^ v; });
+	std::cout << "Is 1 == " << (full != 0) << "?" << std::endl;
+
+	std::cout << "Testing split streams" << std::endl;
+	double whole = lazypp::from::random<double>(7, lazypp::distributions::normal<double>())
+		.take(1000)
+		.fold(0.0, sum);
+	double halves = lazypp::from::random<double>(7, lazypp::distributions::normal<double>(), 0)
+		.take(500)
+		.fold(0.0, sum)
+		+ lazypp::from::random<double>(7, lazypp::distributions::normal<double>(), 500)
+		.take(500)
+		.fold(0.0, sum);
+	std::cout << "Is " << whole << " == " << halves << "?" << std::endl;
+
+	std::cout << "Testing block generation" << std::endl;
+	auto source = lazypp::from::random<double>(3, lazypp::distributions::uniform<double>(-1.0, 1.0));
+	std::vector<double> block(4);
+	source.iterator().fill(block.data(), block.size());
+	for (auto&& v : block)
+		std::cout << v << std::endl;
+	std::cout << "Is " << block[2] << " == " << source.iterator().at(2) << "?" << std::endl;
+
+	return 0;
+}
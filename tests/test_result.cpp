@@ -0,0 +1,79 @@
+#include <lazypp/core.hpp>
+#include <string>
+#include <vector>
+#include <iostream>
+
+enum class parse_error { empty, not_a_number };
+
+lazypp::result<int, parse_error> parse(const std::string& s) {
+	if (s.empty())
+		return lazypp::failure(parse_error::empty);
+	int v = 0;
+	for (char c : s) {
+		if (c < '0' || c > '9')
+			return lazypp::failure(parse_error::not_a_number);
+		v = v * 10 + (c - '0');
+	}
+	return v;
+}
+
+lazypp::result<int, parse_error> halve(int v) {
+	if (v % 2)
+		return lazypp::failure(parse_error::not_a_number);
+	return v / 2;
+}
+
+int main() {
+	std::vector<std::string> fields = {"12", "7", "", "x1", "40", "3"};
+
+	std::cout << "Testing filter_ok" << std::endl;
+	std::cout << "Is 62 == " << lazypp::from::stl_container(fields)
+		.try_map(parse)
+		.filter_ok()
+		.fold(0, [](int acum, int v) { return acum + v; }) << "?" << std::endl;
+
+	std::cout << "Testing collect_errors" << std::endl;
+	std::vector<parse_error> errors;
+	std::vector<int> values = lazypp::from::stl_container(fields)
+		.try_map(parse)
+		.collect_errors(errors)
+		.to<std::vector<int>>();
+	std::cout << "Is 4 == " << values.size() << "?" << std::endl;
+	std::cout << "Is 2 == " << errors.size() << "?" << std::endl;
+	std::cout << "Is 1 == " << (errors[0] == parse_error::empty && errors[1] == parse_error::not_a_number) << "?" << std::endl;
+
+	std::cout << "Testing chained try_map" << std::endl;
+	std::cout << "Is 26 == " << lazypp::from::stl_container(fields)
+		.try_map(parse)
+		.try_map(halve)
+		.filter_ok()
+		.fold(0, [](int acum, int v) { return acum + v; }) << "?" << std::endl;
+
+	std::cout << "Testing try_fold" << std::endl;
+	auto failed = lazypp::from::stl_container(fields)
+		.try_map(parse)
+		.try_fold(0, [](int acum, int v) { return acum + v; });
+	std::cout << "Is 1 == " << (!failed && failed.error() == parse_error::empty) << "?" << std::endl;
+	auto sum = lazypp::from::stl_container(fields)
+		.take(2)
+		.try_map(parse)
+		.try_fold(0, [](int acum, int v) { return acum + v; });
+	std::cout << "Is 19 == " << *sum << "?" << std::endl;
+
+	std::cout << "Testing try_to" << std::endl;
+	auto all = lazypp::from::stl_container(fields)
+		.filter([](const std::string& s) { return !s.empty(); })
+		.take(2)
+		.try_map(parse)
+		.try_to<std::vector<int>>();
+	std::cout << "Is 2 == " << all->size() << "?" << std::endl;
+
+	std::cout << "Testing first_error" << std::endl;
+	auto first = lazypp::from::stl_container(fields)
+		.try_map(parse)
+		.try_map(halve)
+		.first_error();
+	std::cout << "Is 1 == " << (first && *first == parse_error::not_a_number) << "?" << std::endl;
+
+	return 0;
+}
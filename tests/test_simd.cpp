@@ -0,0 +1,56 @@
+#include <lazypp.hpp>
+#include <array>
+#include <string>
+#include <vector>
+#include <iostream>
+
+int main() {
+	const char* names[] = {"scalar", "sse2", "avx2", "avx512"};
+	lazypp::simd_level host = lazypp::host_simd_level();
+	std::cout << "Host level " << names[int(host)] << std::endl;
+
+	std::string text;
+	for (int i = 0; i < 500; i++)
+		text += std::to_string(i) + ",\"a, " + std::to_string(i * 7) + "\nb\"," + std::string(i % 13, 'x') + "\n";
+	std::vector<uint64_t> values = lazypp::from::range(uint64_t(0), uint64_t(1000))
+		.map([](uint64_t v) { return v * 0x9E3779B97F4A7C15ull; })
+		.to<std::vector<uint64_t>>();
+
+	auto csv_sizes = [&text]() {
+		return lazypp::from::csv<3>(text)
+			.fold(size_t(0), [](size_t acum, const std::array<std::string_view, 3>& row) {
+					return acum * 31 + row[0].size() * 7 + row[1].size() * 3 + row[2].size();
+				});
+	};
+	auto unpacked = [&values](unsigned bits) {
+		std::vector<uint64_t> words = lazypp::from::stl_container(values)
+			.bitpack(bits)
+			.to<std::vector<uint64_t>>();
+		return lazypp::from::bitpacked<uint64_t>(words, values.size(), bits)
+			.to<std::vector<uint64_t>>();
+	};
+
+	std::cout << "Is 0 == " << int(lazypp::limit_simd_level(lazypp::simd_level::scalar)) << "?" << std::endl;
+	size_t expected_csv = csv_sizes();
+	std::vector<std::vector<uint64_t>> expected_unpacked;
+	for (unsigned bits = 0; bits <= 64; bits++)
+		expected_unpacked.push_back(unpacked(bits));
+
+	for (int level = 1; level <= int(host); level++) {
+		std::cout << "Testing " << names[level] << " kernels" << std::endl;
+		std::cout << "Is " << level << " == " << int(lazypp::limit_simd_level(lazypp::simd_level(level))) << "?" << std::endl;
+		std::cout << "Is " << expected_csv << " == " << csv_sizes() << "?" << std::endl;
+		bool same = true;
+		for (unsigned bits = 0; bits <= 64; bits++)
+			same = same && unpacked(bits) == expected_unpacked[bits];
+		std::cout << "Is 1 == " << same << "?" << std::endl;
+		if (expected_csv != csv_sizes() || !same)
+			return 1;
+	}
+
+	std::cout << "Testing the level is capped by the host" << std::endl;
+	std::cout << "Is " << int(host) << " == " << int(lazypp::limit_simd_level(lazypp::simd_level::avx512)) << "?" << std::endl;
+	std::cout << "Is " << int(host) << " == " << int(lazypp::active_simd_level()) << "?" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include <lazypp.hpp>
+#include <set>
+#include <string>
+#include <vector>
+#include <iostream>
+
+int main() {
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+
+	std::string text =
+		"GET /index.html 200\n"
+		"POST /api/login 401\n"
+		"HEAD /index.html 200\n"
+		"GET /static/app.js 304\n"
+		"\n"
+		"DELETE /api/session 204";
+
+	std::cout << "Testing filter_contains" << std::endl;
+	lazypp::from::lines(text)
+		.filter_contains("/api/")
+		.each([](std::string_view line) { std::cout << line << std::endl; });
+
+	std::cout << "Testing filter_prefix" << std::endl;
+	std::cout << "Is 2 == " << lazypp::from::lines(text)
+		.filter_prefix("GET ")
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing filter_equals_any" << std::endl;
+	lazypp::from::lines(text)
+		.map([](std::string_view line) { return line.substr(0, line.find(' ')); })
+		.filter_equals_any({"HEAD", "DELETE", ""})
+		.each([](std::string_view method) { std::cout << "[" << method << "]" << std::endl; });
+
+	std::cout << "Testing predicates on std::string elements" << std::endl;
+	std::vector<std::string> words {"alpha", "beta", "alphabet", "gamma"};
+	std::cout << "Is 2 == " << lazypp::from::stl_container(words).filter_prefix(std::string("alpha")).fold(size_t(0), count) << "?" << std::endl;
+	std::cout << "Is 1 == " << lazypp::from::stl_container(words).filter(lazypp::where::equals_any(std::set<std::string>{"beta", "delta"})).fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing filter_equals_any on a larger set" << std::endl;
+	std::vector<std::string> squares = lazypp::from::range(0, 20)
+		.map([](int v) { return std::to_string(v * v); })
+		.to<std::vector<std::string>>();
+	std::cout << "Is 10 == " << lazypp::from::range(0, 100)
+		.map([](int v) { return std::to_string(v); })
+		.filter_equals_any(squares)
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	// haystacks of every length around the block sizes, against the plain
+	// std::string_view versions, at each SIMD level the host has
+	std::vector<std::string> haystacks;
+	for (size_t n = 0; n < 200; n++) {
+		std::string s;
+		for (size_t i = 0; i < n; i++)
+			s += "ab\xe9"[(i * 7 + n) % 3];
+		haystacks.push_back(s);
+		haystacks.push_back(s + "abba");
+		haystacks.push_back("abba" + s);
+	}
+	std::vector<std::string> needles {"", "a", "ab", "ba", "abba", "a\xe9" "b", std::string(70, 'a'), std::string(20, 'b') + "a"};
+	for (size_t n = 1; n < 80; n += 7)
+		needles.push_back(haystacks[n * 3].substr(0, n));
+
+	auto count_matches = [&haystacks, &needles]() {
+		size_t mismatches = 0;
+		for (const std::string& needle : needles) {
+			lazypp::where::contains contains(needle);
+			lazypp::where::starts_with starts_with(needle);
+			lazypp::where::equals_any equals_any({std::string_view(needle), std::string_view("abba")});
+			for (std::string_view s : haystacks) {
+				mismatches += contains(s) != (s.find(needle) != std::string_view::npos);
+				mismatches += starts_with(s) != (s.substr(0, needle.size()) == needle);
+				mismatches += equals_any(s) != (s == needle || s == "abba");
+			}
+		}
+		return mismatches;
+	};
+	const char* names[] = {"scalar", "sse2", "avx2", "avx512"};
+	for (int level = 0; level <= int(lazypp::host_simd_level()); level++) {
+		std::cout << "Testing " << names[level] << " kernels" << std::endl;
+		lazypp::limit_simd_level(lazypp::simd_level(level));
+		size_t mismatches = count_matches();
+		std::cout << "Is 0 == " << mismatches << "?" << std::endl;
+		if (mismatches)
+			return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+#include <lazypp/core.hpp>
+#include <lazypp/algorithms.hpp>
+#include <lazypp/io.hpp>
+#include <lazypp/sources.hpp>
+#include <type_traits>
+#include <vector>
+#include <iostream>
+
+template<typename Wrapper>
+using iterator_of = std::remove_reference_t<decltype(std::declval<Wrapper&>().iterator())>;
+
+auto square = [](int v) noexcept { return v * v; };
+auto even = [](int v) noexcept { return v % 2 == 0; };
+auto small = [](int v) noexcept { return v < 100; };
+auto throwing = [](int v) { if (v < 0) throw std::invalid_argument("negative"); return v; };
+
+/**
+ * Only the rvalue overload, the one map calls, may throw.
+ */
+struct picky {
+	int operator()(int& v) const noexcept { return v; }
+	int operator()(int&& v) const { if (v < 0) throw std::invalid_argument("negative"); return v; }
+};
+
+using plain = decltype(lazypp::from::range(0, 10).map(square).filter(even).take(3).take_while(small));
+using staged = decltype(lazypp::from::range(0, 10).staged(lazypp::stage::map(square), lazypp::stage::filter(even), lazypp::stage::take(3)));
+using throws = decltype(lazypp::from::range(0, 10).map(square).map(throwing).filter(even));
+using vector = decltype(lazypp::from::stl_container(std::declval<std::vector<int>&>()).map(square));
+
+// pipelines over trivially copyable functions are trivially copyable themselves
+static_assert(std::is_trivially_copyable_v<iterator_of<plain>>);
+static_assert(std::is_trivially_copyable_v<iterator_of<staged>>);
+static_assert(std::is_trivially_copyable_v<iterator_of<vector>>);
+static_assert(std::is_nothrow_move_constructible_v<plain>);
+
+// stages holding buffers move them instead of copying (no user declared copy constructors)
+static_assert(std::is_nothrow_move_constructible_v<lazypp::iterators::directory_iterator>);
+static_assert(std::is_nothrow_move_constructible_v<iterator_of<decltype(lazypp::from::lines(lazypp::from::lines("a")))>>);
+static_assert(std::is_nothrow_move_constructible_v<iterator_of<decltype(lazypp::from::range(0, 10).gather(std::declval<std::vector<int>&>()))>>);
+static_assert(std::is_trivially_copyable_v<iterator_of<decltype(lazypp::from::grid(lazypp::grid_region{0, 4, 0, 4}))>>);
+
+// next() is noexcept unless one of the functions may throw
+static_assert(noexcept(std::declval<iterator_of<plain>&>().next()));
+static_assert(noexcept(std::declval<iterator_of<staged>&>().next()));
+static_assert(noexcept(std::declval<iterator_of<vector>&>().next()));
+static_assert(!noexcept(std::declval<iterator_of<throws>&>().next()));
+static_assert(!noexcept(std::declval<iterator_of<decltype(lazypp::from::range(0, 10).staged(lazypp::stage::map(throwing)))>&>().next()));
+static_assert(!noexcept(std::declval<iterator_of<decltype(lazypp::from::range(0, 10).map(picky()))>&>().next()));
+static_assert(!noexcept(std::declval<iterator_of<decltype(lazypp::from::range(0, 10).staged(lazypp::stage::map(picky())))>&>().next()));
+
+int main() {
+	std::vector<iterator_of<plain>> copies(4, lazypp::from::range(0, 10).map(square).filter(even).take(3).take_while(small).iterator());
+	int sum = 0;
+	for (auto& it : copies)
+		while (auto v = it.next())
+			sum += *v;
+	std::cout << "Is 80 == " << sum << "?" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,56 @@
+#define LAZYPP_WITH_ZSTD
+#include <lazypp.hpp>
+#include <string>
+#include <iostream>
+
+int main() {
+	auto count = [](size_t acum, auto&&) { return acum + 1; };
+	auto bytes = [](size_t acum, std::string_view block) { return acum + block.size(); };
+	std::string fixture = std::string(FIXTURES_DIR) + "/log.txt.zst";
+
+	std::cout << "Testing zstd blocks" << std::endl;
+	std::cout << "Is 106512 == " << lazypp::from::zstd_file(fixture).fold(size_t(0), bytes) << "?" << std::endl;
+
+	std::cout << "Testing zstd blocks smaller than its window" << std::endl;
+	std::cout << "Is 106512 == " << lazypp::from::zstd_file(fixture, 1000).fold(size_t(0), bytes) << "?" << std::endl;
+	std::cout << "Is 3000 == " << lazypp::from::lines(lazypp::from::zstd_file(fixture, 777))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing zstd output buffered past the end of the input" << std::endl;
+	std::cout << "Is 100000 == " << lazypp::from::lines(lazypp::from::zstd_file(std::string(FIXTURES_DIR) + "/repeated.txt.zst", 1000))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing zstd csv" << std::endl;
+	std::cout << "Is 604 == " << lazypp::from::csv<2>(lazypp::from::lines(lazypp::from::zstd_file(fixture, 4096)))
+		.filter([](auto&& row) { return row[1] == "error"; })
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing concatenated zstd frames" << std::endl;
+	lazypp::mapped_file file(fixture);
+	std::string twice = std::string(file.view()) + std::string(file.view());
+	std::cout << "Is 6000 == " << lazypp::from::lines(lazypp::from::zstd(twice, 1000))
+		.fold(size_t(0), count) << "?" << std::endl;
+
+	std::cout << "Testing truncated zstd" << std::endl;
+	std::string truncated = std::string(file.view()).substr(0, file.view().size() - 100);
+	try {
+		lazypp::from::zstd(truncated).each([](auto&&) {});
+		std::cout << "no error" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	std::cout << "Testing corrupted zstd" << std::endl;
+	std::string corrupted = std::string(file.view());
+	corrupted[corrupted.size() / 2] ^= 0x55;
+	try {
+		lazypp::from::zstd(corrupted).each([](auto&&) {});
+		std::cout << "no error" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cout << e.what() << std::endl;
+	}
+
+	return 0;
+}